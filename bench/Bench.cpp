@@ -0,0 +1,132 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::vector<Bench::Source> Bench::DatasetSources() {
+    // clang-format off
+    return {
+        {"River", DATA_DIR "Terrain/River.png", DATA_DIR "Terrain/RiverType.png", 15.0f, 3.0f},
+        {"Lake", DATA_DIR "Terrain/Lake.png", "", 15.0f, 3.0f},
+        {"Hill", DATA_DIR "Terrain/Hill.png", "", 15.0f, -1.0f},
+        {"AlpsMontBlanc", DATA_DIR "Terrain/AlpsMontBlanc.png", "", 15.0f, -1.0f},
+    };
+    // clang-format on
+}
+
+std::vector<Bench::Dataset> Bench::LoadDatasets() {
+    std::vector<Dataset> datasets;
+    for (const auto& source : DatasetSources()) {
+        datasets.push_back({source.name,
+                            Terrain::Load(source.heightPath, source.typePath, {100.0f, 100.0f},
+                                          source.heightScale, source.waterHeight)});
+    }
+    return datasets;
+}
+
+std::vector<Bench::Query>
+Bench::RandomQueries(const Terrain& terrain, const uint32_t seed, const int count) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> distX(0, terrain.dimensions.x - 1);
+    std::uniform_int_distribution<int> distY(0, terrain.dimensions.y - 1);
+
+    const auto randomLandCell = [&]() {
+        while (true) {
+            const glm::ivec2 p(distX(rng), distY(rng));
+            if (terrain.typeMap(p.x, p.y) != Terrain::TileType::WATER)
+                return p;
+        }
+    };
+
+    std::vector<Query> queries(count);
+    for (auto& [start, end] : queries) {
+        start = randomLandCell();
+        end = randomLandCell();
+    }
+    return queries;
+}
+
+double Bench::Percentile(std::vector<double> values, const double p) {
+    if (values.empty())
+        return 0.0;
+
+    std::ranges::sort(values);
+    const auto i = static_cast<size_t>(std::lround(p * static_cast<double>(values.size() - 1)));
+    return values[i];
+}
+
+double Bench::PeakMemoryMiB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0.0;
+    return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0); // Bytes
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024.0; // KiB
+#endif
+#endif
+}
+
+Bench::CacheMissCounter::CacheMissCounter(const Level level) {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    if (level == Level::L1D) {
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    } else {
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    }
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void)level;
+#endif
+}
+
+Bench::CacheMissCounter::~CacheMissCounter() {
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+}
+
+uint64_t Bench::CacheMissCounter::Read() const {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (fd >= 0 && read(fd, &count, sizeof(count)) != sizeof(count))
+        count = 0;
+#endif
+    return count;
+}
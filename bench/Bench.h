@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Terrain.h"
+
+// Small in-repo benchmark harness: bundled datasets, reproducible query sets and timing helpers
+namespace Bench {
+
+    struct Dataset {
+        std::string name;
+        Terrain terrain;
+    };
+
+    // Files and load settings of a dataset, for the suites that load it again
+    struct Source {
+        std::string name;
+        std::filesystem::path heightPath;
+        std::filesystem::path typePath;
+        float heightScale;
+        float waterHeight;
+    };
+
+    struct Query {
+        glm::ivec2 start;
+        glm::ivec2 end;
+    };
+
+    // Shared by every suite, set from the command line
+    struct Options {
+        int queryCount = 20;
+        uint32_t seed = 42;
+    };
+
+    // The terrains of data/Terrain
+    std::vector<Source> DatasetSources();
+    std::vector<Dataset> LoadDatasets();
+
+    // Same seed, same queries. Both ends are on land.
+    std::vector<Query> RandomQueries(const Terrain& terrain, uint32_t seed, int count);
+
+    // p in [0, 1]
+    double Percentile(std::vector<double> values, double p);
+
+    // Peak resident set size of the process so far, in MiB
+    double PeakMemoryMiB();
+
+    // Hardware cache misses of the calling thread since construction, through the Linux perf
+    // events. Available() is false elsewhere, or when the kernel denies access
+    // (see /proc/sys/kernel/perf_event_paranoid).
+    class CacheMissCounter {
+    public:
+        enum class Level { L1D, LLC };
+
+        explicit CacheMissCounter(Level level);
+        ~CacheMissCounter();
+
+        CacheMissCounter(const CacheMissCounter&) = delete;
+        CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+        bool Available() const { return fd >= 0; }
+        uint64_t Read() const;
+
+    private:
+        int fd = -1;
+    };
+
+    class Timer {
+    public:
+        Timer() : start(std::chrono::steady_clock::now()) {}
+
+        double ElapsedSec() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+} // namespace Bench
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include "AnytimePlanner.h"
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// AnytimePlanner (ARA*) driven like the viewer does, a few milliseconds per frame, against one
+// A* search: frames and time until the first path, its actual cost ratio against the bound it
+// reports, then frames and time until the optimal path.
+void BenchAnytime(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    constexpr double FRAME_BUDGET_SEC = 0.004;
+
+    ThreadPool pool;
+
+    std::printf("%-14s %8s %10s %8s %8s %8s %10s %10s\n", "dataset", "frames", "first p50",
+                "ratio", "bound", "frames", "done p50", "a* p50");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+        const float heuristicScale = Metric::DistanceCost::HeuristicScale(0.1f);
+        const auto connectivity = PathFinder::Connectivity::C8;
+        const auto grid = std::make_shared<const EdgeCostGrid>(
+            PathFinder::BakeEdgeCosts(terrain.dimensions, pool, distance, slope, type));
+
+        std::vector<double> firstMs, doneMs, searchMs;
+        double firstFrames = 0.0, doneFrames = 0.0, ratio = 0.0, bound = 0.0;
+        int found = 0;
+        SearchWorkspace workspace;
+        AnytimePlanner planner;
+
+        for (const auto& [start, end] : queries) {
+            const Bench::Timer searchTimer;
+            const auto reference = PathFinder()
+                                       .From(start.x, start.y)
+                                       .To(end.x, end.y)
+                                       .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                       .SetConnectivity(connectivity)
+                                       .SetSearchMode(PathFinder::SearchMode::A_STAR)
+                                       .SetHeuristicScale(heuristicScale)
+                                       .SetEdgeCosts(grid)
+                                       .Compute(workspace, distance, slope, type);
+            searchMs.push_back(searchTimer.ElapsedSec() * 1e3);
+
+            planner.Start(grid, connectivity, heuristicScale, start, end);
+            int frames = 0;
+            bool first = true;
+            while (!planner.Done()) {
+                planner.Improve(FRAME_BUDGET_SEC);
+                frames++;
+
+                if (first && planner.Best()) {
+                    first = false;
+                    firstMs.push_back(planner.ElapsedSec() * 1e3);
+                    firstFrames += frames;
+                    if (reference && reference.cost > 0.0f) {
+                        ratio += planner.Best().cost / reference.cost;
+                        bound += planner.Bound();
+                        found++;
+                    }
+                }
+            }
+            doneMs.push_back(planner.ElapsedSec() * 1e3);
+            doneFrames += frames;
+        }
+
+        const auto count = static_cast<double>(queries.size());
+        const double foundCount = std::max(found, 1);
+        std::printf("%-14s %8.1f %10.3f %8.3f %8.3f %8.1f %10.3f %10.3f\n", name.c_str(),
+                    firstFrames / std::max<double>(firstMs.size(), 1.0),
+                    Bench::Percentile(firstMs, 0.5), ratio / foundCount, bound / foundCount,
+                    doneFrames / count, Bench::Percentile(doneMs, 0.5),
+                    Bench::Percentile(searchMs, 0.5));
+    }
+}
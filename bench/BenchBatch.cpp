@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// PathFinder::ComputeBatch() throughput for 1, 2, 4, ... threads up to the core count.
+// Speedups are relative to the single thread run of the same dataset.
+void BenchBatch(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%-14s %7s %10s %10s %9s\n", "dataset", "threads", "total ms", "queries/s",
+                "speedup");
+
+    for (const auto& [name, terrain] : datasets) {
+        // A batch is many queries: use several times the usual count
+        const auto queries = Bench::RandomQueries(terrain, options.seed, 4 * options.queryCount);
+
+        std::vector<PathFinder::Query> batch;
+        for (const auto& [start, end] : queries)
+            batch.push_back({start, end});
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+
+        const auto finder = PathFinder()
+                                .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                .SetConnectivity(PathFinder::Connectivity::C8)
+                                .SetSearchMode(PathFinder::SearchMode::A_STAR)
+                                .SetHeuristicScale(Metric::DistanceCost::HeuristicScale(0.1f));
+
+        double baseSec = 0.0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            ThreadPool pool(threads);
+            std::vector<SearchWorkspace> workspaces;
+
+            const Bench::Timer timer;
+            const auto paths = finder.ComputeBatch(batch, pool, workspaces, distance, slope, type);
+            const double totalSec = timer.ElapsedSec();
+
+            if (threads == 1)
+                baseSec = totalSec;
+
+            std::printf("%-14s %7u %10.1f %10.1f %8.2fx\n", name.c_str(), threads, totalSec * 1e3,
+                        static_cast<double>(paths.size()) / totalSec, baseSec / totalSec);
+        }
+    }
+}
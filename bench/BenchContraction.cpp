@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+#include "Bench.h"
+#include "ContractionHierarchy.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// ContractionHierarchy against A* on the same costs: preprocessing, cache file round trip,
+// query latency and cost agreement. "mismatch" counts the queries only one of them found a
+// path for: always a bug.
+void BenchContraction(const std::vector<Bench::Dataset>& datasets,
+                      const Bench::Options& options) {
+    ThreadPool pool;
+    const auto cachePath = std::filesystem::temp_directory_path() / "hmroute_bench.contraction";
+
+    std::printf("%-14s %10s %10s %9s %8s %9s %10s %10s %10s %10s %9s\n", "dataset", "arcs",
+                "shortcuts", "build s", "MiB", "load ms", "ch p50", "ch p99", "a* p50",
+                "max err", "mismatch");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+        const auto connectivity = PathFinder::Connectivity::C8;
+
+        // Released before the reload: the largest maps take gigabytes to build
+        double buildSec = 0.0;
+        {
+            const Bench::Timer buildTimer;
+            const auto built = ContractionHierarchy::Build(terrain.dimensions, connectivity, pool,
+                                                           distance, slope, type);
+            buildSec = buildTimer.ElapsedSec();
+            built.Save(cachePath);
+        }
+
+        const auto fileMiB = static_cast<double>(std::filesystem::file_size(cachePath)) / 1048576.0;
+        const Bench::Timer loadTimer;
+        const auto hierarchy =
+            std::make_shared<ContractionHierarchy>(ContractionHierarchy::Load(cachePath));
+        const double loadSec = loadTimer.ElapsedSec();
+        std::filesystem::remove(cachePath);
+
+        const auto edgeCosts = std::make_shared<EdgeCostGrid>(
+            PathFinder::BakeEdgeCosts(terrain.dimensions, pool, distance, slope, type));
+        const auto base = PathFinder()
+                              .Size(terrain.dimensions.x, terrain.dimensions.y)
+                              .SetConnectivity(connectivity)
+                              .SetHeuristicScale(Metric::DistanceCost::HeuristicScale(0.1f))
+                              .SetEdgeCosts(edgeCosts);
+        const auto contracted =
+            PathFinder(base).SetContractionHierarchy(hierarchy, distance, slope, type);
+        const auto exact = PathFinder(base).SetSearchMode(PathFinder::SearchMode::A_STAR);
+
+        std::vector<double> chLatencies, exactLatencies;
+        double maxError = 0.0;
+        int mismatches = 0;
+        SearchWorkspace workspace;
+
+        for (const auto& [start, end] : queries) {
+            const Bench::Timer chTimer;
+            const auto path = PathFinder(contracted)
+                                  .From(start.x, start.y)
+                                  .To(end.x, end.y)
+                                  .Compute(workspace, distance, slope, type);
+            chLatencies.push_back(chTimer.ElapsedSec() * 1e3);
+
+            const Bench::Timer exactTimer;
+            const auto reference = PathFinder(exact)
+                                       .From(start.x, start.y)
+                                       .To(end.x, end.y)
+                                       .Compute(workspace, distance, slope, type);
+            exactLatencies.push_back(exactTimer.ElapsedSec() * 1e3);
+
+            if (static_cast<bool>(path) != static_cast<bool>(reference))
+                mismatches++;
+
+            // Relative cost difference: only float rounding is expected
+            if (path && reference && reference.cost > 0.0f)
+                maxError = std::max(maxError, std::abs(path.cost - reference.cost) /
+                                        static_cast<double>(reference.cost));
+        }
+
+        std::printf("%-14s %10zu %10zu %9.1f %8.1f %9.1f %10.3f %10.3f %10.3f %9.4f%% %9d\n",
+                    name.c_str(), hierarchy->ArcCount(), hierarchy->ShortcutCount(), buildSec,
+                    fileMiB, loadSec * 1e3,
+                    Bench::Percentile(chLatencies, 0.5), Bench::Percentile(chLatencies, 0.99),
+                    Bench::Percentile(exactLatencies, 0.5), 100.0 * maxError, mismatches);
+    }
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "Bench.h"
+#include "EdgeCostCache.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// Queries with the metrics evaluated on the fly versus read from a baked EdgeCostGrid, for the
+// fused kernels and the type-erased ones (With()). The bake time is reported apart: it is paid
+// once per terrain and weights.
+void BenchEdgeCosts(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    using SearchMode = PathFinder::SearchMode;
+
+    constexpr std::pair<SearchMode, const char*> MODES[] = {
+        {SearchMode::DIJKSTRA, "dijkstra"},
+        {SearchMode::A_STAR, "a*"},
+    };
+
+    ThreadPool pool;
+
+    std::printf("%-14s %-9s %-7s %9s %12s %12s %9s %10s\n", "dataset", "search", "metrics",
+                "bake ms", "metrics ms", "baked ms", "speedup", "max error");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+
+        EdgeCostCache cache;
+        const Bench::Timer bakeTimer;
+        const auto edgeCosts = cache.Get(terrain.dimensions, pool, distance, slope, type);
+        const double bakeSec = bakeTimer.ElapsedSec();
+
+        SearchWorkspace workspace;
+
+        for (const auto& [mode, modeName] : MODES) {
+            for (const bool erased : {false, true}) {
+                const auto run = [&](const std::shared_ptr<const EdgeCostGrid>& grid,
+                                     std::vector<float>& costs) {
+                    const Bench::Timer timer;
+                    for (const auto& [start, end] : queries) {
+                        auto finder = PathFinder()
+                                          .From(start.x, start.y)
+                                          .To(end.x, end.y)
+                                          .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                          .SetConnectivity(PathFinder::Connectivity::C8)
+                                          .SetSearchMode(mode)
+                                          .SetHeuristicScale(
+                                              Metric::DistanceCost::HeuristicScale(0.1f))
+                                          .SetEdgeCosts(grid);
+                        const auto path = erased
+                            ? finder.With(distance.weight, distance.cost)
+                                  .With(slope.weight, slope.cost)
+                                  .With(type.weight, type.cost)
+                                  .Compute(workspace)
+                            : finder.Compute(workspace, distance, slope, type);
+                        costs.push_back(path.cost);
+                    }
+                    return timer.ElapsedSec();
+                };
+
+                std::vector<float> reference, baked;
+                const double metricsSec = run(nullptr, reference);
+                const double bakedSec = run(edgeCosts, baked);
+
+                float maxError = 0.0f;
+                for (size_t i = 0; i < reference.size(); i++)
+                    maxError = std::max(maxError, std::abs(reference[i] - baked[i]));
+
+                std::printf("%-14s %-9s %-7s %9.1f %12.1f %12.1f %8.2fx %10.4f\n", name.c_str(),
+                            modeName, erased ? "erased" : "fused", bakeSec * 1e3,
+                            metricsSec * 1e3, bakedSec * 1e3, metricsSec / bakedSec, maxError);
+            }
+        }
+    }
+}
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+namespace {
+
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    // Where cell (x, y) lives in a grid stored with each layout. The tiled ones are padded to
+    // whole tiles, the tiles in row-major order.
+
+    struct RowMajor {
+        static constexpr const char* NAME = "row";
+
+        explicit RowMajor(const glm::ivec2& size) :
+            width(static_cast<uint32_t>(size.x)), count(static_cast<size_t>(size.x) * size.y) {}
+
+        uint32_t operator()(const int x, const int y) const {
+            return static_cast<uint32_t>(y) * width + static_cast<uint32_t>(x);
+        }
+
+        uint32_t width;
+        size_t count;
+    };
+
+    // Row-major 8x8 tiles: a C8 neighborhood spans 1 to 4 tiles of 256 bytes (floats)
+    // instead of 3 rows of the map
+    struct Tiled {
+        static constexpr const char* NAME = "tiled";
+        static constexpr uint32_t SHIFT = 3;
+        static constexpr uint32_t MASK = (1u << SHIFT) - 1;
+
+        explicit Tiled(const glm::ivec2& size) :
+            tilesX((static_cast<uint32_t>(size.x) + MASK) >> SHIFT) {
+            const uint32_t tilesY = (static_cast<uint32_t>(size.y) + MASK) >> SHIFT;
+            count = static_cast<size_t>(tilesX) * tilesY << (2 * SHIFT);
+        }
+
+        uint32_t operator()(const int x, const int y) const {
+            const auto ux = static_cast<uint32_t>(x);
+            const auto uy = static_cast<uint32_t>(y);
+            const uint32_t tile = (uy >> SHIFT) * tilesX + (ux >> SHIFT);
+            return (tile << (2 * SHIFT)) | ((uy & MASK) << SHIFT) | (ux & MASK);
+        }
+
+        uint32_t tilesX;
+        size_t count;
+    };
+
+    // Z-order inside 32x32 tiles: the cells close in both axes are close in memory at every
+    // scale up to the tile
+    struct Morton {
+        static constexpr const char* NAME = "morton";
+        static constexpr uint32_t SHIFT = 5;
+        static constexpr uint32_t MASK = (1u << SHIFT) - 1;
+
+        explicit Morton(const glm::ivec2& size) :
+            tilesX((static_cast<uint32_t>(size.x) + MASK) >> SHIFT) {
+            const uint32_t tilesY = (static_cast<uint32_t>(size.y) + MASK) >> SHIFT;
+            count = static_cast<size_t>(tilesX) * tilesY << (2 * SHIFT);
+        }
+
+        // The bits of v (below 2^16) spread to the even positions
+        static uint32_t Spread(uint32_t v) {
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            return (v | (v << 1)) & 0x55555555u;
+        }
+
+        uint32_t operator()(const int x, const int y) const {
+            const auto ux = static_cast<uint32_t>(x);
+            const auto uy = static_cast<uint32_t>(y);
+            const uint32_t tile = (uy >> SHIFT) * tilesX + (ux >> SHIFT);
+            return (tile << (2 * SHIFT)) | Spread(ux & MASK) | (Spread(uy & MASK) << 1);
+        }
+
+        uint32_t tilesX;
+        size_t count;
+    };
+
+    // The height and type maps, and the search state, all stored with the same layout
+    template <typename Layout>
+    struct LayoutGrids {
+        explicit LayoutGrids(const Terrain& terrain) :
+            size(terrain.dimensions), layout(size), heights(layout.count), types(layout.count),
+            stamps(layout.count, 0), costs(layout.count), parents(layout.count) {
+            for (int y = 0; y < size.y; y++) {
+                for (int x = 0; x < size.x; x++) {
+                    heights[layout(x, y)] = terrain.heightMap(x, y) * terrain.heightScale;
+                    types[layout(x, y)] = terrain.typeMap(x, y);
+                }
+            }
+        }
+
+        glm::ivec2 size;
+        Layout layout;
+        std::vector<float> heights; // Scaled
+        std::vector<Terrain::TileType> types;
+
+        // Generation-stamped, as in SearchWorkspace::Frontier
+        uint32_t epoch = 0;
+        std::vector<uint32_t> stamps;
+        std::vector<float> costs;
+        std::vector<uint32_t> parents;
+    };
+
+    // Set-associative cache of 64-byte lines with LRU eviction, fed the addresses the search
+    // touches. Counts the misses on machines without the perf events, the same way everywhere.
+    class CacheModel {
+    public:
+        CacheModel(const size_t bytes, const size_t ways) :
+            ways(ways), sets(bytes / LINE / ways), lines(sets * ways, EMPTY) {}
+
+        // True on a hit
+        bool Access(const void* address) {
+            const uint64_t line = reinterpret_cast<uintptr_t>(address) / LINE;
+            const auto set = lines.begin() + static_cast<ptrdiff_t>(line % sets * ways);
+            const auto end = set + static_cast<ptrdiff_t>(ways);
+
+            // Most recent first
+            const auto found = std::find(set, end, line);
+            if (found != end) {
+                std::rotate(set, found, found + 1);
+                return true;
+            }
+            misses++;
+            std::rotate(set, end - 1, end);
+            *set = line;
+            return false;
+        }
+
+        uint64_t Misses() const { return misses; }
+
+    private:
+        static constexpr size_t LINE = 64;
+        static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+        size_t ways;
+        size_t sets;
+        std::vector<uint64_t> lines;
+        uint64_t misses = 0;
+    };
+
+    // A 32 KiB L1d in front of a 1 MiB L2, as on most current x86 cores
+    struct SimulatedCaches {
+        CacheModel l1 = CacheModel(32 * 1024, 8);
+        CacheModel l2 = CacheModel(1024 * 1024, 16);
+
+        void operator()(const void* address) {
+            if (!l1.Access(address))
+                l2.Access(address);
+        }
+    };
+
+    struct NoProbe {
+        void operator()(const void*) const {}
+    };
+
+    // Dijkstra in C8 from start to end with the PathFinder::Compute() weights of the suite, the
+    // metrics evaluated on the fly. Every grid read or write goes through `probe`; the queue
+    // is the same for every layout and is left out.
+    template <typename Layout, typename Probe>
+    float LayoutSearch(LayoutGrids<Layout>& grids,
+                       const glm::ivec2& start,
+                       const glm::ivec2& end,
+                       PriorityQueue::BinaryHeap& queue,
+                       Probe& probe) {
+        const auto& layout = grids.layout;
+        const glm::ivec2 size = grids.size;
+
+        if (++grids.epoch == 0) {
+            std::ranges::fill(grids.stamps, 0);
+            grids.epoch = 1;
+        }
+        const uint32_t epoch = grids.epoch;
+
+        // The queue holds packed coordinates: no layout has to be inverted
+        const auto pack = [](const int x, const int y) {
+            return static_cast<uint32_t>(y) << 16 | static_cast<uint32_t>(x);
+        };
+
+        queue.Reset(0);
+        const uint32_t first = layout(start.x, start.y);
+        grids.stamps[first] = epoch;
+        grids.costs[first] = 0.0f;
+        grids.parents[first] = first;
+        queue.Push({pack(start.x, start.y), 0.0f});
+
+        while (!queue.Empty()) {
+            const auto [packed, cost] = queue.Top();
+            queue.Pop();
+
+            const int x = static_cast<int>(packed & 0xFFFF);
+            const int y = static_cast<int>(packed >> 16);
+            const uint32_t i = layout(x, y);
+            probe(&grids.costs[i]);
+            if (cost > grids.costs[i])
+                continue;
+            if (x == end.x && y == end.y)
+                return cost;
+
+            probe(&grids.heights[i]);
+            probe(&grids.types[i]);
+            const float h1 = grids.heights[i];
+            const Terrain::TileType t1 = grids.types[i];
+
+            for (int dir = 0; dir < EdgeCostGrid::DIRECTION_COUNT; dir++) {
+                const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                const int nx = x + dx;
+                const int ny = y + dy;
+                if (nx < 0 || nx >= size.x || ny < 0 || ny >= size.y)
+                    continue;
+
+                const uint32_t n = layout(nx, ny);
+                probe(&grids.heights[n]);
+                probe(&grids.types[n]);
+
+                // Summed in the order of PathFinder::Compute(distance, slope, type)
+                const PathFinder::Edge edge(x, y, nx, ny, d, false, dir);
+                float step = 0.0f;
+                step += 0.1f * Metric::DistanceCost{}(edge);
+                step += 1.0f * Metric::SlopeCost::FromHeights(h1, grids.heights[n], d);
+                step += 10.0f * Metric::TerrainCost::FromTypes(t1, grids.types[n], edge);
+                if (std::isinf(step))
+                    continue;
+
+                probe(&grids.stamps[n]);
+                const bool visited = grids.stamps[n] == epoch;
+                if (visited)
+                    probe(&grids.costs[n]);
+                if (!visited || cost + step < grids.costs[n]) {
+                    probe(&grids.costs[n]);
+                    probe(&grids.parents[n]);
+                    grids.stamps[n] = epoch;
+                    grids.costs[n] = cost + step;
+                    grids.parents[n] = i;
+                    queue.Push({pack(nx, ny), cost + step});
+                }
+            }
+        }
+        return INF;
+    }
+
+    std::string Count(const uint64_t count) {
+        return std::to_string(count);
+    }
+
+    std::string Count(const Bench::CacheMissCounter& counter, const uint64_t count) {
+        return counter.Available() ? Count(count) : std::string("n/a");
+    }
+
+} // namespace
+
+// Dijkstra in C8 with every grid it reads (heights, types, search costs, stamps and parents)
+// stored row-major, in 8x8 tiles and in Z-order, against PathFinder::Compute() on the row-major
+// maps. Cache misses from the perf events where available ("n/a" otherwise), and from
+// a simulated L1d/L2 fed the grid accesses of the same queries. Errors are against PathFinder.
+void BenchGridLayout(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    std::printf("%-14s %-10s %10s %10s %13s %13s %13s %13s %10s\n", "dataset", "layout",
+                "total ms", "queries/s", "L1d misses", "LLC misses", "L1d sim", "L2 sim",
+                "max error");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+
+        const auto report = [&](const char* layout, const double sec, const std::string& l1d,
+                                const std::string& llc, const std::string& l1dSim,
+                                const std::string& l2Sim, const float error) {
+            std::printf("%-14s %-10s %10.1f %10.1f %13s %13s %13s %13s %10.4f\n", name.c_str(),
+                        layout, sec * 1e3, static_cast<double>(queries.size()) / sec,
+                        l1d.c_str(), llc.c_str(), l1dSim.c_str(), l2Sim.c_str(), error);
+        };
+
+        std::vector<float> reference;
+        {
+            SearchWorkspace workspace;
+
+            const Bench::CacheMissCounter l1d(Bench::CacheMissCounter::Level::L1D);
+            const Bench::CacheMissCounter llc(Bench::CacheMissCounter::Level::LLC);
+            const Bench::Timer timer;
+            for (const auto& [start, end] : queries) {
+                const auto path = PathFinder()
+                                      .From(start.x, start.y)
+                                      .To(end.x, end.y)
+                                      .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                      .SetConnectivity(PathFinder::Connectivity::C8)
+                                      .Compute(workspace, distance, slope, type);
+                reference.push_back(path ? path.cost : INF);
+            }
+            const double sec = timer.ElapsedSec();
+            const uint64_t l1dMisses = l1d.Read();
+            const uint64_t llcMisses = llc.Read();
+
+            report("pathfinder", sec, Count(l1d, l1dMisses), Count(llc, llcMisses), "-", "-",
+                   0.0f);
+        }
+
+        const auto run = [&]<typename Layout>(std::type_identity<Layout>) {
+            LayoutGrids<Layout> grids(terrain);
+            PriorityQueue::BinaryHeap queue;
+            std::vector<float> costs;
+
+            NoProbe none;
+            const Bench::CacheMissCounter l1d(Bench::CacheMissCounter::Level::L1D);
+            const Bench::CacheMissCounter llc(Bench::CacheMissCounter::Level::LLC);
+            const Bench::Timer timer;
+            for (const auto& [start, end] : queries)
+                costs.push_back(LayoutSearch(grids, start, end, queue, none));
+            const double sec = timer.ElapsedSec();
+            const uint64_t l1dMisses = l1d.Read();
+            const uint64_t llcMisses = llc.Read();
+
+            // Same queries again, untimed, through the cache model
+            SimulatedCaches caches;
+            for (const auto& [start, end] : queries)
+                LayoutSearch(grids, start, end, queue, caches);
+
+            float maxError = 0.0f;
+            for (size_t i = 0; i < queries.size(); i++) {
+                if (!std::isinf(reference[i]) || !std::isinf(costs[i]))
+                    maxError = std::max(maxError, std::abs(reference[i] - costs[i]));
+            }
+
+            report(Layout::NAME, sec, Count(l1d, l1dMisses), Count(llc, llcMisses),
+                   Count(caches.l1.Misses()), Count(caches.l2.Misses()), maxError);
+        };
+
+        run(std::type_identity<RowMajor>{});
+        run(std::type_identity<Tiled>{});
+        run(std::type_identity<Morton>{});
+    }
+}
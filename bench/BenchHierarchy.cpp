@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+#include "Bench.h"
+#include "ClusterHierarchy.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// ClusterHierarchy against exact A* on the same baked costs: preprocessing, cache file
+// round trip, query latency and how far the hierarchical routes are from the optimum.
+void BenchHierarchy(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    ThreadPool pool;
+    const auto cachePath = std::filesystem::temp_directory_path() / "hmroute_bench.hierarchy";
+
+    std::printf("%-14s %8s %9s %9s %8s %10s %10s %10s %10s %10s\n", "dataset", "nodes",
+                "build ms", "load ms", "MiB", "hpa p50", "hpa p99", "a* p50", "mean err",
+                "max err");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+        const float heuristicScale = Metric::DistanceCost::HeuristicScale(0.1f);
+
+        const auto edgeCosts = std::make_shared<EdgeCostGrid>(
+            PathFinder::BakeEdgeCosts(terrain.dimensions, pool, distance, slope, type));
+
+        const Bench::Timer buildTimer;
+        const auto built = ClusterHierarchy::Build(edgeCosts, {}, pool);
+        const double buildSec = buildTimer.ElapsedSec();
+
+        built.Save(cachePath);
+        const auto fileMiB = static_cast<double>(std::filesystem::file_size(cachePath)) / 1048576.0;
+        const Bench::Timer loadTimer;
+        const auto hierarchy = ClusterHierarchy::Load(cachePath, edgeCosts);
+        const double loadSec = loadTimer.ElapsedSec();
+        std::filesystem::remove(cachePath);
+
+        std::vector<double> hpaLatencies, exactLatencies;
+        double sumError = 0.0, maxError = 0.0;
+        int compared = 0;
+        SearchWorkspace workspace;
+
+        for (const auto& [start, end] : queries) {
+            const Bench::Timer hpaTimer;
+            const auto path = hierarchy.Compute(start, end, heuristicScale);
+            hpaLatencies.push_back(hpaTimer.ElapsedSec() * 1e3);
+
+            const Bench::Timer exactTimer;
+            const auto exact = PathFinder()
+                                   .From(start.x, start.y)
+                                   .To(end.x, end.y)
+                                   .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                   .SetConnectivity(PathFinder::Connectivity::C8)
+                                   .SetSearchMode(PathFinder::SearchMode::A_STAR)
+                                   .SetHeuristicScale(heuristicScale)
+                                   .SetEdgeCosts(edgeCosts)
+                                   .Compute(workspace, distance, slope, type);
+            exactLatencies.push_back(exactTimer.ElapsedSec() * 1e3);
+
+            // Relative excess cost, on the routes both found
+            if (path && exact && exact.cost > 0.0f) {
+                const double error = (path.cost - exact.cost) / exact.cost;
+                sumError += error;
+                maxError = std::max(maxError, error);
+                compared++;
+            }
+        }
+
+        std::printf("%-14s %8zu %9.1f %9.1f %8.1f %10.3f %10.3f %10.3f %9.2f%% %9.2f%%\n",
+                    name.c_str(), hierarchy.NodeCount(), buildSec * 1e3, loadSec * 1e3, fileMiB,
+                    Bench::Percentile(hpaLatencies, 0.5), Bench::Percentile(hpaLatencies, 0.99),
+                    Bench::Percentile(exactLatencies, 0.5),
+                    compared > 0 ? 100.0 * sumError / compared : 0.0, 100.0 * maxError);
+    }
+}
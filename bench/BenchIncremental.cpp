@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+#include "Bench.h"
+#include "IncrementalPlanner.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// IncrementalPlanner (D* Lite) against a new A* search after each change of an interactive
+// session: dragging the start one cell at a time, then the end, then painting a patch of forest
+// across the route. Latency and nodes expanded per change, and the cost difference.
+void BenchIncremental(const std::vector<Bench::Dataset>& datasets,
+                      const Bench::Options& options) {
+    constexpr int DRAG_STEPS = 20;
+    constexpr int PATCH_SIZE = 24;
+    constexpr const char* PHASES[] = {"first", "drag start", "drag end", "edit"};
+
+    ThreadPool pool;
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<int> step(-1, 1);
+
+    std::printf("%-14s %-11s %10s %10s %12s %12s %10s\n", "dataset", "change", "d* p50",
+                "a* p50", "d* nodes", "a* nodes", "max err");
+
+    for (const auto& [name, terrain] : datasets) {
+        // A drag session is long: a few of them are enough
+        const auto queries =
+            Bench::RandomQueries(terrain, options.seed, std::max(1, options.queryCount / 10));
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const float heuristicScale = Metric::DistanceCost::HeuristicScale(0.1f);
+        const auto connectivity = PathFinder::Connectivity::C8;
+
+        std::vector<double> incrementalMs[4], searchMs[4];
+        double incrementalNodes[4] = {}, searchNodes[4] = {};
+        double maxError = 0.0;
+        SearchWorkspace workspace;
+
+        for (auto [start, end] : queries) {
+            auto typeMap = terrain.typeMap;
+            auto grid = std::make_shared<const EdgeCostGrid>(PathFinder::BakeEdgeCosts(
+                terrain.dimensions, pool, distance, slope,
+                PathFinder::Weighted{10.0f, Metric::TerrainCost{typeMap}}));
+
+            IncrementalPlanner planner;
+            planner.SetConnectivity(connectivity);
+            planner.SetHeuristicScale(heuristicScale);
+            planner.SetEdgeCosts(grid);
+
+            const auto measure = [&](const int phase) {
+                const Bench::Timer incrementalTimer;
+                planner.SetStart(start);
+                planner.SetGoal(end);
+                const auto path = planner.Plan();
+                incrementalMs[phase].push_back(incrementalTimer.ElapsedSec() * 1e3);
+
+                const Bench::Timer searchTimer;
+                const auto reference =
+                    PathFinder()
+                        .From(start.x, start.y)
+                        .To(end.x, end.y)
+                        .Size(terrain.dimensions.x, terrain.dimensions.y)
+                        .SetConnectivity(connectivity)
+                        .SetSearchMode(PathFinder::SearchMode::A_STAR)
+                        .SetHeuristicScale(heuristicScale)
+                        .SetEdgeCosts(grid)
+                        .Compute(workspace, distance, slope,
+                                 PathFinder::Weighted{10.0f, Metric::TerrainCost{typeMap}});
+                searchMs[phase].push_back(searchTimer.ElapsedSec() * 1e3);
+
+                incrementalNodes[phase] += static_cast<double>(path.nodesExpanded);
+                searchNodes[phase] += static_cast<double>(reference.nodesExpanded);
+                if (path && reference && reference.cost > 0.0f)
+                    maxError = std::max(maxError, std::abs(path.cost - reference.cost) /
+                                            static_cast<double>(reference.cost));
+                return path;
+            };
+
+            const auto drag = [&](glm::ivec2& flag) {
+                flag = glm::clamp(flag + glm::ivec2(step(rng), step(rng)), glm::ivec2(0),
+                                  terrain.dimensions - 1);
+            };
+
+            auto path = measure(0);
+            for (int i = 0; i < DRAG_STEPS; i++) {
+                drag(start);
+                path = measure(1);
+            }
+            for (int i = 0; i < DRAG_STEPS; i++) {
+                drag(end);
+                path = measure(2);
+            }
+
+            // Forest across the middle of the route, then only its edges are compared
+            const glm::ivec2 middle = path ? glm::ivec2(path.points[path.points.size() / 2])
+                                           : (start + end) / 2;
+            const glm::ivec2 low = glm::max(middle - PATCH_SIZE / 2, glm::ivec2(0));
+            const glm::ivec2 high = glm::min(middle + PATCH_SIZE / 2, terrain.dimensions - 1);
+            for (int y = low.y; y <= high.y; y++)
+                for (int x = low.x; x <= high.x; x++)
+                    if (typeMap(x, y) != Terrain::TileType::WATER)
+                        typeMap(x, y) = Terrain::TileType::FOREST;
+
+            grid = std::make_shared<const EdgeCostGrid>(PathFinder::BakeEdgeCosts(
+                terrain.dimensions, pool, distance, slope,
+                PathFinder::Weighted{10.0f, Metric::TerrainCost{typeMap}}));
+            planner.SetEdgeCosts(grid, low - 1, high + 1);
+            measure(3);
+        }
+
+        for (int phase = 0; phase < 4; phase++) {
+            const auto count = static_cast<double>(incrementalMs[phase].size());
+            std::printf("%-14s %-11s %10.3f %10.3f %12.0f %12.0f %9.4f%%\n", name.c_str(),
+                        PHASES[phase], Bench::Percentile(incrementalMs[phase], 0.5),
+                        Bench::Percentile(searchMs[phase], 0.5), incrementalNodes[phase] / count,
+                        searchNodes[phase] / count, 100.0 * maxError);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "Algorithm.h"
+#include "Bench.h"
+
+// The implementations Algorithm::NormalMap() and Algorithm::Gradient() replaced, kept as
+// the baseline: per pixel border branches and glm::normalize.
+static Mat<glm::vec3> BaselineNormalMap(const Mat<float>& heights, const float scale) {
+    const auto size = heights.Size();
+    auto normals = Mat<glm::vec3>(size);
+
+    for (uint32_t y = 0; y < size.y; y++) {
+        for (uint32_t x = 0; x < size.x; x++) {
+            const float hL = (x > 0) ? heights(x - 1, y) : heights(x, y);
+            const float hR = (x < size.x - 1) ? heights(x + 1, y) : heights(x, y);
+            const float hD = (y > 0) ? heights(x, y - 1) : heights(x, y);
+            const float hU = (y < size.y - 1) ? heights(x, y + 1) : heights(x, y);
+
+            auto tangent = glm::vec3(2.0f, (hR - hL) * scale, 0.0f);
+            auto bitangent = glm::vec3(0.0f, (hU - hD) * scale, 2.0f);
+
+            normals(x, y) = glm::normalize(glm::cross(bitangent, tangent));
+        }
+    }
+    return normals;
+}
+
+static Mat<glm::vec2> BaselineGradient(const Mat<float>& in) {
+    const auto size = in.Size();
+    Mat<glm::vec2> out(size);
+
+    for (uint32_t y = 0; y < size.y; y++) {
+        for (uint32_t x = 0; x < size.x; x++) {
+            auto& o = out(x, y);
+
+            if (y == 0)
+                o.y = in(x, y) - in(x, y + 1);
+            else if (y == size.y - 1)
+                o.y = in(x, y - 1) - in(x, y);
+            else
+                o.y = in(x, y - 1) - in(x, y + 1);
+
+            if (x == 0)
+                o.x = in(x, y) - in(x + 1, y);
+            else if (x == size.x - 1)
+                o.x = in(x - 1, y) - in(x, y);
+            else
+                o.x = in(x - 1, y) - in(x + 1, y);
+
+            o *= 0.5f;
+        }
+    }
+    return out;
+}
+
+// Large DEM made of tiled copies of a bundled one
+static Mat<float> Tile(const Mat<float>& mat, const uint32_t count) {
+    Mat<float> out(mat.Size() * count);
+    for (uint32_t y = 0; y < out.Height(); y++)
+        for (uint32_t x = 0; x < out.Width(); x++)
+            out(x, y) = mat(x % mat.Width(), y % mat.Height());
+    return out;
+}
+
+// Over all the components
+template <typename T>
+static float MaxDifference(const Mat<T>& a, const Mat<T>& b) {
+    const auto* fa = reinterpret_cast<const float*>(a.Data());
+    const auto* fb = reinterpret_cast<const float*>(b.Data());
+    const size_t count = a.Width() * a.Height() * sizeof(T) / sizeof(float);
+
+    float diff = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        diff = std::max(diff, std::abs(fa[i] - fb[i]));
+    return diff;
+}
+
+struct KernelVersion {
+    std::string name;
+    ThreadPool* pool;
+    Algorithm::Simd simd;
+};
+
+// Best of a few runs, in Mpixels/s
+template <typename Run>
+static double MpixelsPerSec(const Mat<float>& map, const Run& run) {
+    double best = 1e30;
+    for (int i = 0; i < 5; i++) {
+        const Bench::Timer timer;
+        run();
+        best = std::min(best, timer.ElapsedSec());
+    }
+    return static_cast<double>(map.Width()) * map.Height() / best / 1e6;
+}
+
+// baseline(map) against kernel(map, pool, simd) for every version
+template <typename Baseline, typename Kernel>
+static void BenchKernel(const std::string& mapName,
+                        const char* kernelName,
+                        const Mat<float>& map,
+                        const std::vector<KernelVersion>& versions,
+                        const Baseline& baseline,
+                        const Kernel& kernel) {
+    const auto reference = baseline(map);
+    const double baselineSpeed = MpixelsPerSec(map, [&]() { baseline(map); });
+    std::printf("%-18s %-9s %-22s %10.1f %8.2fx %10.2e\n", mapName.c_str(), kernelName,
+                "baseline", baselineSpeed, 1.0, 0.0);
+
+    for (const auto& [name, pool, simd] : versions) {
+        const double speed = MpixelsPerSec(map, [&]() { kernel(map, *pool, simd); });
+        const float diff = MaxDifference(reference, kernel(map, *pool, simd));
+        std::printf("%-18s %-9s %-22s %10.1f %8.2fx %10.2e\n", mapName.c_str(), kernelName,
+                    name.c_str(), speed, speed / baselineSpeed, diff);
+    }
+}
+
+// Mpixels/s of NormalMap and Gradient: baseline, scalar and SIMD on one thread, SIMD on
+// all cores. The last map is the largest dataset tiled 4x4.
+void BenchKernels(const std::vector<Bench::Dataset>& datasets, const Bench::Options&) {
+    using Simd = Algorithm::Simd;
+
+    ThreadPool single(1);
+    ThreadPool all;
+
+    const Simd simd = Algorithm::DetectSimd();
+    const std::string simdName = simd == Simd::AVX2 ? "avx2"
+        : simd == Simd::NEON                        ? "neon"
+                                                    : "scalar";
+
+    const std::vector<KernelVersion> versions = {
+        {"scalar", &single, Simd::SCALAR},
+        {simdName, &single, simd},
+        {simdName + ", " + std::to_string(all.ThreadCount()) + " threads", &all, simd},
+    };
+
+    std::vector<std::pair<std::string, Mat<float>>> maps;
+    for (const auto& [name, terrain] : datasets)
+        maps.emplace_back(name, terrain.heightMap);
+    maps.emplace_back(datasets.back().name + " 4x4", Tile(datasets.back().terrain.heightMap, 4));
+
+    std::printf("%-18s %-9s %-22s %10s %9s %10s\n", "map", "kernel", "version", "Mpixels/s",
+                "speedup", "max diff");
+
+    for (const auto& [name, map] : maps) {
+        BenchKernel(
+            name, "normals", map, versions,
+            [](const Mat<float>& m) { return BaselineNormalMap(m, 15.0f); },
+            [](const Mat<float>& m, ThreadPool& pool, const Simd s) {
+                return Algorithm::NormalMap(m, 15.0f, pool, s);
+            });
+        BenchKernel(name, "gradient", map, versions, BaselineGradient,
+                    [](const Mat<float>& m, ThreadPool& pool, const Simd s) {
+                        return Algorithm::Gradient(m, pool, s);
+                    });
+    }
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+namespace {
+
+    // The search state before the packed indices: (x, y) queue entries, a bounds check
+    // per neighbor and row-major conversions on every access. Kept as the reference.
+    struct CoordNode {
+        int x, y;
+        float cost;
+
+        bool operator>(const CoordNode& other) const { return cost > other.cost; }
+    };
+
+    template <typename EdgeCost>
+    float CoordSearch(const glm::ivec2& size,
+                      const glm::ivec2& start,
+                      const glm::ivec2& end,
+                      const EdgeCost& edgeCost,
+                      std::vector<float>& costs,
+                      std::vector<int>& parents,
+                      size_t& nodesExpanded) {
+        constexpr float INF = std::numeric_limits<float>::infinity();
+        const auto inBounds = [&](const int x, const int y) {
+            return x >= 0 && x < size.x && y >= 0 && y < size.y;
+        };
+        const auto index = [&](const int x, const int y) { return y * size.x + x; };
+
+        costs.assign(static_cast<size_t>(size.x) * size.y, INF);
+        parents.assign(costs.size(), -1);
+
+        std::priority_queue<CoordNode, std::vector<CoordNode>, std::greater<>> pq;
+        costs[index(start.x, start.y)] = 0.0f;
+        pq.push({start.x, start.y, 0.0f});
+
+        while (!pq.empty()) {
+            const auto [cx, cy, cost] = pq.top();
+            pq.pop();
+
+            const int parent = index(cx, cy);
+            if (cost > costs[parent])
+                continue;
+            if (cx == end.x && cy == end.y)
+                return cost;
+            nodesExpanded++;
+
+            for (int dir = 0; dir < EdgeCostGrid::DIRECTION_COUNT; dir++) {
+                const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                const int nx = cx + dx;
+                const int ny = cy + dy;
+                if (!inBounds(nx, ny))
+                    continue;
+
+                const float step = edgeCost(PathFinder::Edge(cx, cy, nx, ny, d, false, dir));
+                if (std::isinf(step))
+                    continue;
+
+                const int i = index(nx, ny);
+                if (cost + step < costs[i]) {
+                    costs[i] = cost + step;
+                    parents[i] = parent;
+                    pq.push({nx, ny, cost + step});
+                }
+            }
+        }
+        return INF;
+    }
+
+} // namespace
+
+// Dijkstra in C8 on the packed search state (8-byte queue entries, bordered grid) against
+// the former coordinate layout, on the same queries and weights.
+void BenchLayout(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    std::printf("%-14s %-7s %11s %10s %10s %14s %10s\n", "dataset", "layout", "entry bytes",
+                "total ms", "queries/s", "nodes expanded", "max error");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+        const auto fused = [&](const PathFinder::Edge& edge) {
+            return distance.weight * distance.cost(edge) + slope.weight * slope.cost(edge) +
+                   type.weight * type.cost(edge);
+        };
+
+        std::vector<float> packedCosts;
+        size_t packedExpanded = 0;
+        SearchWorkspace workspace;
+
+        const Bench::Timer packedTimer;
+        for (const auto& [start, end] : queries) {
+            const auto path = PathFinder()
+                                  .From(start.x, start.y)
+                                  .To(end.x, end.y)
+                                  .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                  .SetConnectivity(PathFinder::Connectivity::C8)
+                                  .Compute(workspace, distance, slope, type);
+            packedExpanded += path.nodesExpanded;
+            packedCosts.push_back(path ? path.cost : std::numeric_limits<float>::infinity());
+        }
+        const double packedSec = packedTimer.ElapsedSec();
+
+        std::vector<float> coordCosts;
+        size_t coordExpanded = 0;
+        std::vector<float> costs;
+        std::vector<int> parents;
+
+        const Bench::Timer coordTimer;
+        for (const auto& [start, end] : queries) {
+            coordCosts.push_back(
+                CoordSearch(terrain.dimensions, start, end, fused, costs, parents, coordExpanded));
+        }
+        const double coordSec = coordTimer.ElapsedSec();
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (!std::isinf(packedCosts[i]) || !std::isinf(coordCosts[i]))
+                maxError = std::max(maxError, std::abs(packedCosts[i] - coordCosts[i]));
+        }
+
+        const auto report = [&](const char* layout, const size_t entryBytes, const double sec,
+                                const size_t expanded, const float error) {
+            std::printf("%-14s %-7s %11zu %10.1f %10.1f %14zu %10.4f\n", name.c_str(), layout,
+                        entryBytes, sec * 1e3, static_cast<double>(queries.size()) / sec, expanded,
+                        error);
+        };
+        report("coords", sizeof(CoordNode), coordSec, coordExpanded, 0.0f);
+        report("packed", sizeof(PriorityQueue::Node), packedSec, packedExpanded, maxError);
+    }
+}
@@ -0,0 +1,40 @@
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "Terrain.h"
+#include "ThreadPool.h"
+
+// Terrain::Load stages, serial and on a pool: decode of both files (at once on the pool), then
+// the fused normalization and classification pass. Medians of a few loads.
+void BenchLoad(const std::vector<Bench::Dataset>&, const Bench::Options&) {
+    constexpr int REPEATS = 5;
+    ThreadPool pool;
+
+    std::printf("%-14s %-8s %11s %11s %11s %11s\n", "dataset", "mode", "height ms", "type ms",
+                "convert ms", "total ms");
+
+    for (const auto& source : Bench::DatasetSources()) {
+        for (const bool pooled : {false, true}) {
+            std::vector<double> height, type, convert, total;
+            for (int i = 0; i < REPEATS; i++) {
+                const auto terrain = pooled
+                    ? Terrain::Load(source.heightPath, source.typePath, pool, {100.0f, 100.0f},
+                                    source.heightScale, source.waterHeight)
+                    : Terrain::Load(source.heightPath, source.typePath, {100.0f, 100.0f},
+                                    source.heightScale, source.waterHeight);
+
+                const auto& t = terrain.loadTimings;
+                height.push_back(t.heightDecodeSec * 1e3);
+                type.push_back(t.typeDecodeSec * 1e3);
+                convert.push_back(t.convertSec * 1e3);
+                total.push_back(t.totalSec * 1e3);
+            }
+
+            std::printf("%-14s %-8s %11.2f %11.2f %11.2f %11.2f\n", source.name.c_str(),
+                        pooled ? "pool" : "serial", Bench::Percentile(height, 0.5),
+                        Bench::Percentile(type, 0.5), Bench::Percentile(convert, 0.5),
+                        Bench::Percentile(total, 0.5));
+        }
+    }
+}
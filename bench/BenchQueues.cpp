@@ -0,0 +1,75 @@
+#include <cmath>
+#include <cstdio>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// Compares the PathFinder queue implementations on the same query set.
+// Errors are relative to the binary heap, which is exact.
+void BenchQueues(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    using QueueType = PathFinder::QueueType;
+    using SearchMode = PathFinder::SearchMode;
+
+    constexpr std::pair<QueueType, const char*> QUEUES[] = {
+        {QueueType::BINARY_HEAP, "binary"},
+        {QueueType::QUATERNARY_HEAP, "4-ary"},
+        {QueueType::RADIX_HEAP, "radix"},
+        {QueueType::BUCKET, "bucket"},
+    };
+    constexpr std::pair<SearchMode, const char*> MODES[] = {
+        {SearchMode::DIJKSTRA, "dijkstra"},
+        {SearchMode::A_STAR, "a*"},
+    };
+
+    std::printf("%-14s %-9s %-7s %10s %10s %14s %10s\n", "dataset", "search", "queue", "total ms",
+                "queries/s", "nodes expanded", "max error");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+
+        SearchWorkspace workspace;
+
+        for (const auto& [mode, modeName] : MODES) {
+            std::vector<float> reference;
+
+            for (const auto& [queue, queueName] : QUEUES) {
+                size_t nodesExpanded = 0;
+                float maxError = 0.0f;
+                std::vector<float> costs;
+
+                const Bench::Timer timer;
+                for (const auto& [start, end] : queries) {
+                    const auto path = PathFinder()
+                                          .From(start.x, start.y)
+                                          .To(end.x, end.y)
+                                          .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                          .SetConnectivity(PathFinder::Connectivity::C8)
+                                          .SetSearchMode(mode)
+                                          .SetHeuristicScale(
+                                              Metric::DistanceCost::HeuristicScale(0.1f))
+                                          .SetQueue(queue)
+                                          .Compute(workspace, distance, slope, type);
+                    nodesExpanded += path.nodesExpanded;
+                    costs.push_back(path.cost);
+                }
+                const double totalSec = timer.ElapsedSec();
+
+                if (reference.empty())
+                    reference = costs;
+                for (size_t i = 0; i < costs.size(); i++)
+                    maxError = std::max(maxError, std::abs(costs[i] - reference[i]));
+
+                std::printf("%-14s %-9s %-7s %10.1f %10.1f %14zu %10.4f\n", name.c_str(), modeName,
+                            queueName, totalSec * 1e3,
+                            static_cast<double>(queries.size()) / totalSec, nodesExpanded,
+                            maxError);
+            }
+        }
+    }
+}
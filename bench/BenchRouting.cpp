@@ -0,0 +1,65 @@
+#include <cstdio>
+#include <memory>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+
+// Default PathFinder settings (Dijkstra, binary heap) in C4/C8, with and without bridges.
+// Meant to catch regressions in PathFinder and Metric: the query sets never change.
+void BenchRouting(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    using Connectivity = PathFinder::Connectivity;
+
+    constexpr std::pair<Connectivity, const char*> CONNECTIVITIES[] = {
+        {Connectivity::C4, "C4"},
+        {Connectivity::C8, "C8"},
+    };
+
+    std::printf("%-14s %-4s %-7s %10s %14s %10s %10s %9s %10s\n", "dataset", "conn", "bridges",
+                "queries/s", "nodes expanded", "p50 ms", "p99 ms", "found", "peak MiB");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const auto bridges = std::make_shared<BridgeNetwork>(BridgeNetwork::Generate(terrain, {}));
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+
+        SearchWorkspace workspace;
+
+        for (const auto& [connectivity, connectivityName] : CONNECTIVITIES) {
+            for (const bool allowBridges : {false, true}) {
+                std::vector<double> latencies;
+                size_t nodesExpanded = 0;
+                int found = 0;
+
+                const Bench::Timer total;
+                for (const auto& [start, end] : queries) {
+                    const Bench::Timer timer;
+                    const auto path = PathFinder()
+                                          .From(start.x, start.y)
+                                          .To(end.x, end.y)
+                                          .Size(terrain.dimensions.x, terrain.dimensions.y)
+                                          .SetConnectivity(connectivity)
+                                          .AllowBridges(allowBridges)
+                                          .SetBridges(bridges)
+                                          .Compute(workspace, distance, slope, type);
+                    latencies.push_back(timer.ElapsedSec() * 1e3);
+
+                    nodesExpanded += path.nodesExpanded;
+                    found += path ? 1 : 0;
+                }
+                const double totalSec = total.ElapsedSec();
+
+                std::printf("%-14s %-4s %-7s %10.1f %14zu %10.2f %10.2f %5d/%-3zu %10.1f\n",
+                            name.c_str(), connectivityName, allowBridges ? "yes" : "no",
+                            static_cast<double>(queries.size()) / totalSec, nodesExpanded,
+                            Bench::Percentile(latencies, 0.5), Bench::Percentile(latencies, 0.99),
+                            found, queries.size(), Bench::PeakMemoryMiB());
+            }
+        }
+    }
+}
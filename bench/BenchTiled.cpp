@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+#include "Bench.h"
+#include "Metric.h"
+#include "PathFinder.h"
+#include "TiledTerrain.h"
+
+// TiledTerrain against the loaded maps: conversion, open time, file size, query latency on the
+// mapped tiles and cost agreement (the heights are quantized to 16 bits).
+void BenchTiled(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options) {
+    const auto tiledPath = std::filesystem::temp_directory_path() / "hmroute_bench.tiled";
+
+    std::printf("%-14s %9s %9s %8s %10s %10s %10s\n", "dataset", "write ms", "open ms", "MiB",
+                "mat p50", "tiled p50", "max err");
+
+    for (const auto& [name, terrain] : datasets) {
+        const auto queries = Bench::RandomQueries(terrain, options.seed, options.queryCount);
+
+        const Bench::Timer writeTimer;
+        TiledTerrain::Write(terrain, tiledPath);
+        const double writeSec = writeTimer.ElapsedSec();
+
+        const Bench::Timer openTimer;
+        const auto tiled = TiledTerrain::Open(tiledPath);
+        const double openSec = openTimer.ElapsedSec();
+        const auto fileMiB = static_cast<double>(std::filesystem::file_size(tiledPath)) / 1048576.0;
+
+        const PathFinder::Weighted distance{0.1f, Metric::DistanceCost{}};
+        const PathFinder::Weighted slope{1.0f, Metric::SlopeCost{terrain.heightMap,
+                                                                  terrain.heightScale}};
+        const PathFinder::Weighted type{10.0f, Metric::TerrainCost{terrain.typeMap}};
+        const PathFinder::Weighted tiledSlope{1.0f,
+                                              Metric::TiledSlopeCost{&tiled, tiled.HeightScale()}};
+        const PathFinder::Weighted tiledType{10.0f, Metric::TiledTerrainCost{&tiled}};
+
+        const auto base = PathFinder()
+                              .Size(terrain.dimensions.x, terrain.dimensions.y)
+                              .SetSearchMode(PathFinder::SearchMode::A_STAR)
+                              .SetHeuristicScale(Metric::DistanceCost::HeuristicScale(0.1f));
+
+        std::vector<double> matLatencies, tiledLatencies;
+        double maxError = 0.0;
+        SearchWorkspace workspace;
+
+        for (const auto& [start, end] : queries) {
+            const Bench::Timer matTimer;
+            const auto reference = PathFinder(base)
+                                       .From(start.x, start.y)
+                                       .To(end.x, end.y)
+                                       .Compute(workspace, distance, slope, type);
+            matLatencies.push_back(matTimer.ElapsedSec() * 1e3);
+
+            const Bench::Timer tiledTimer;
+            const auto path = PathFinder(base)
+                                  .From(start.x, start.y)
+                                  .To(end.x, end.y)
+                                  .Compute(workspace, distance, tiledSlope, tiledType);
+            tiledLatencies.push_back(tiledTimer.ElapsedSec() * 1e3);
+
+            if (path && reference && reference.cost > 0.0f)
+                maxError = std::max(maxError, std::abs(path.cost - reference.cost) /
+                                        static_cast<double>(reference.cost));
+        }
+
+        std::printf("%-14s %9.1f %9.3f %8.1f %10.3f %10.3f %9.4f%%\n", name.c_str(),
+                    writeSec * 1e3, openSec * 1e3, fileMiB, Bench::Percentile(matLatencies, 0.5),
+                    Bench::Percentile(tiledLatencies, 0.5), 100.0 * maxError);
+    }
+
+    std::filesystem::remove(tiledPath);
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Bench.h"
+
+void BenchRouting(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchQueues(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchLayout(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchGridLayout(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchBatch(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchEdgeCosts(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchKernels(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchHierarchy(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchContraction(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchLoad(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchTiled(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchIncremental(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+void BenchAnytime(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+
+struct Suite {
+    const char* name;
+    void (*run)(const std::vector<Bench::Dataset>& datasets, const Bench::Options& options);
+};
+
+static constexpr Suite SUITES[] = {
+    {"routing", BenchRouting},
+    {"queues", BenchQueues},
+    {"layout", BenchLayout},
+    {"grid-layout", BenchGridLayout},
+    {"batch", BenchBatch},
+    {"edge-costs", BenchEdgeCosts},
+    {"kernels", BenchKernels},
+    {"hierarchy", BenchHierarchy},
+    {"contraction", BenchContraction},
+    {"tiled", BenchTiled},
+    {"load", BenchLoad},
+    {"incremental", BenchIncremental},
+    {"anytime", BenchAnytime},
+};
+
+// Usage: hmroute_bench [--queries <n>] [--seed <n>] [suite...] (all suites when none is given)
+int main(const int argc, char** argv) {
+    try {
+        Bench::Options options;
+        std::vector<std::string> selected;
+
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if ((arg == "--queries" || arg == "--seed") && i + 1 >= argc)
+                throw std::runtime_error("hmroute_bench - Missing value for " + arg);
+
+            if (arg == "--queries") {
+                options.queryCount = std::stoi(argv[++i]);
+                if (options.queryCount <= 0)
+                    throw std::runtime_error("hmroute_bench - --queries must be positive");
+            } else if (arg == "--seed") {
+                options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                selected.push_back(arg);
+            }
+        }
+
+        for (const auto& name : selected) {
+            if (std::ranges::none_of(SUITES, [&](const Suite& s) { return name == s.name; }))
+                throw std::runtime_error("hmroute_bench - Unknown suite: " + name);
+        }
+
+        const auto datasets = Bench::LoadDatasets();
+
+        for (const auto& [name, run] : SUITES) {
+            if (!selected.empty() && std::ranges::find(selected, name) == selected.end())
+                continue;
+
+            std::cout << "== " << name << " ==" << std::endl;
+            run(datasets, options);
+            std::cout << std::endl;
+        }
+    } catch (std::exception& e) {
+        std::cerr << "[FATAL ERROR] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
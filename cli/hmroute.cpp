@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ClusterHierarchy.h"
+#include "ContractionHierarchy.h"
+#include "Metric.h"
+#include "PathFinder.h"
+#include "Terrain.h"
+#include "TerrainCache.h"
+#include "TiledTerrain.h"
+
+struct Options {
+    std::filesystem::path heightPath;
+    std::filesystem::path typePath;
+    std::filesystem::path tiledPath;
+    std::filesystem::path terrainCache;
+    std::string queriesPath = "-";
+    std::string outputPath = "-";
+
+    enum class Format { JSON, CSV } format = Format::JSON;
+
+    float heightScale = 15.0f;
+    float waterHeight = -1.0f;
+
+    PathFinder::Connectivity connectivity = PathFinder::Connectivity::C8;
+    PathFinder::SearchMode searchMode = PathFinder::SearchMode::DIJKSTRA;
+    bool bidirectional = false;
+    PathFinder::QueueType queueType = PathFinder::QueueType::BINARY_HEAP;
+    float bucketWidth = 0.01f;
+    unsigned threads = 1;
+    bool bakeEdgeCosts = false;
+    bool hierarchical = false;
+    ClusterHierarchy::Settings hierarchySettings;
+    std::filesystem::path hierarchyCache;
+    bool contraction = false;
+    std::filesystem::path contractionCache;
+    bool allowBridges = false;
+    BridgeNetwork::Settings bridgeSettings;
+    bool timings = false;
+
+    float distanceWeight = 0.1f;
+    float slopeWeight = 1.0f;
+    float terrainWeight = 10.0f;
+};
+
+using Query = PathFinder::Query;
+
+struct Result {
+    Query query;
+    PathFinder::Path path;
+    double timeSec;
+};
+
+static void PrintUsage(std::ostream& out);
+static Options ParseArgs(int argc, char** argv);
+static std::vector<Query> ReadQueries(std::istream& in);
+
+// Runs the queries over any terrain source: only the cost kernels differ
+template <typename Distance, typename Slope, typename Type>
+static std::vector<Result> Route(const Options& options,
+                                 ThreadPool& pool,
+                                 glm::ivec2 dimensions,
+                                 const std::vector<Query>& queries,
+                                 const std::shared_ptr<const BridgeNetwork>& bridges,
+                                 const PathFinder::Weighted<Distance>& distance,
+                                 const PathFinder::Weighted<Slope>& slope,
+                                 const PathFinder::Weighted<Type>& type);
+static void WriteJSON(std::ostream& out, const std::vector<Result>& results);
+static void WriteCSV(std::ostream& out, const std::vector<Result>& results);
+
+int main(const int argc, char** argv) {
+    try {
+        const Options options = ParseArgs(argc, argv);
+
+        std::vector<Query> queries;
+        if (options.queriesPath == "-") {
+            queries = ReadQueries(std::cin);
+        } else {
+            std::ifstream in(options.queriesPath);
+            if (!in)
+                throw std::runtime_error("hmroute - Failed to open queries file");
+            queries = ReadQueries(in);
+        }
+
+        // Loads the terrain, runs the batch and bakes the edge costs
+        ThreadPool pool(options.threads);
+
+        std::vector<Result> results;
+        if (!options.tiledPath.empty()) {
+            // Mapped, not loaded: the searches page in the tiles they reach
+            const auto tiled = TiledTerrain::Open(options.tiledPath);
+
+            const PathFinder::Weighted distance{options.distanceWeight, Metric::DistanceCost{}};
+            const PathFinder::Weighted slope{options.slopeWeight,
+                                             Metric::TiledSlopeCost{&tiled, tiled.HeightScale()}};
+            const PathFinder::Weighted type{options.terrainWeight,
+                                            Metric::TiledTerrainCost{&tiled}};
+
+            results = Route(options, pool, glm::ivec2(tiled.Size()), queries, nullptr, distance,
+                            slope, type);
+        } else {
+            // Decoded and classified again only when the inputs changed, with a cache file
+            bool cacheHit = false;
+            const Terrain terrain = [&] {
+                if (options.terrainCache.empty())
+                    return Terrain::Load(options.heightPath, options.typePath, pool, {1.0f, 1.0f},
+                                         options.heightScale, options.waterHeight);
+
+                auto cached = TerrainCache::LoadOrBuild(options.terrainCache, options.heightPath,
+                                                        options.typePath, pool, {1.0f, 1.0f},
+                                                        options.heightScale, options.waterHeight);
+                cacheHit = cached.hit;
+                return std::move(cached.terrain);
+            }();
+
+            if (options.timings) {
+                const auto& t = terrain.loadTimings;
+                if (cacheHit)
+                    std::cerr << "load: cache hit, total " << t.totalSec * 1e3 << " ms\n";
+                else
+                    std::cerr << "load: height decode " << t.heightDecodeSec * 1e3
+                              << " ms, type decode " << t.typeDecodeSec * 1e3 << " ms, convert "
+                              << t.convertSec * 1e3 << " ms, total " << t.totalSec * 1e3
+                              << " ms\n";
+            }
+
+            // Built once, shared by all the queries
+            std::shared_ptr<const BridgeNetwork> bridges;
+            if (options.allowBridges)
+                bridges = std::make_shared<BridgeNetwork>(
+                    BridgeNetwork::Generate(terrain, options.bridgeSettings));
+
+            // The metrics only hold views on the terrain maps: no copy per query
+            const Metric::SlopeCost slopeCost{terrain.heightMap, terrain.heightScale};
+            const Metric::TerrainCost terrainCost{terrain.typeMap};
+
+            const PathFinder::Weighted distance{options.distanceWeight, Metric::DistanceCost{}};
+            const PathFinder::Weighted slope{options.slopeWeight, slopeCost};
+            const PathFinder::Weighted type{options.terrainWeight, terrainCost};
+
+            results =
+                Route(options, pool, terrain.dimensions, queries, bridges, distance, slope, type);
+        }
+
+        std::ofstream file;
+        if (options.outputPath != "-") {
+            file.open(options.outputPath);
+            if (!file)
+                throw std::runtime_error("hmroute - Failed to open output file");
+        }
+        std::ostream& out = options.outputPath == "-" ? std::cout : file;
+
+        if (options.format == Options::Format::JSON)
+            WriteJSON(out, results);
+        else
+            WriteCSV(out, results);
+
+    } catch (std::exception& e) {
+        std::cerr << "[FATAL ERROR] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+template <typename Distance, typename Slope, typename Type>
+std::vector<Result> Route(const Options& options,
+                          ThreadPool& pool,
+                          const glm::ivec2 dimensions,
+                          const std::vector<Query>& queries,
+                          const std::shared_ptr<const BridgeNetwork>& bridges,
+                          const PathFinder::Weighted<Distance>& distance,
+                          const PathFinder::Weighted<Slope>& slope,
+                          const PathFinder::Weighted<Type>& type) {
+    const float heuristicScale = Metric::DistanceCost::HeuristicScale(options.distanceWeight);
+
+    std::shared_ptr<const EdgeCostGrid> edgeCosts;
+    if (options.bakeEdgeCosts || options.hierarchical)
+        edgeCosts = std::make_shared<EdgeCostGrid>(
+            PathFinder::BakeEdgeCosts(dimensions, pool, distance, slope, type));
+
+    // Exact routes from a preprocessed profile, used by every query (batches included)
+    std::shared_ptr<const ContractionHierarchy> contraction;
+    if (options.contraction)
+        contraction = std::make_shared<ContractionHierarchy>(
+            options.contractionCache.empty()
+                ? ContractionHierarchy::Build(dimensions, options.connectivity, pool,
+                                              distance, slope, type)
+                : ContractionHierarchy::LoadOrBuild(options.contractionCache,
+                                                    dimensions, options.connectivity,
+                                                    pool, distance, slope, type));
+
+    const auto finder = PathFinder()
+                            .Size(dimensions.x, dimensions.y)
+                            .SetConnectivity(options.connectivity)
+                            .SetSearchMode(options.searchMode)
+                            .SetHeuristicScale(heuristicScale)
+                            .SetBidirectional(options.bidirectional)
+                            .SetQueue(options.queueType, options.bucketWidth)
+                            .AllowBridges(options.allowBridges)
+                            .SetBridges(bridges)
+                            .SetEdgeCosts(edgeCosts)
+                            .SetContractionHierarchy(contraction, distance, slope, type);
+
+    // Preprocessed once (or read back from the cache file): the queries then only search
+    // the clusters at both ends, then the entrances
+    std::optional<ClusterHierarchy> hierarchy;
+    if (options.hierarchical) {
+        auto settings = options.hierarchySettings;
+        settings.connectivity = options.connectivity;
+        hierarchy = options.hierarchyCache.empty()
+            ? ClusterHierarchy::Build(edgeCosts, settings, pool)
+            : ClusterHierarchy::LoadOrBuild(options.hierarchyCache, edgeCosts, settings, pool);
+    }
+    const float hierarchyScale =
+        options.searchMode == PathFinder::SearchMode::A_STAR ? heuristicScale : 0.0f;
+
+    std::vector<Result> results;
+    results.reserve(queries.size());
+
+    if (options.threads == 1) {
+        // Reused by every query: no per-query grid allocation or fill
+        SearchWorkspace workspace;
+
+        for (const auto& query : queries) {
+            const auto t0 = std::chrono::steady_clock::now();
+            auto path = hierarchy
+                ? hierarchy->Compute(query.start, query.end, hierarchyScale)
+                : PathFinder(finder)
+                      .From(query.start.x, query.start.y)
+                      .To(query.end.x, query.end.y)
+                      .Compute(workspace, distance, slope, type);
+            const auto t1 = std::chrono::steady_clock::now();
+
+            const double timeSec = std::chrono::duration<double>(t1 - t0).count();
+            results.push_back({query, std::move(path), timeSec});
+        }
+    } else {
+        std::vector<SearchWorkspace> workspaces;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        std::vector<PathFinder::Path> paths(queries.size());
+        if (hierarchy) {
+            pool.ParallelFor(queries.size(), [&](const size_t i, unsigned) {
+                paths[i] = hierarchy->Compute(queries[i].start, queries[i].end, hierarchyScale);
+            });
+        } else {
+            paths = finder.ComputeBatch(queries, pool, workspaces, distance, slope, type);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+
+        // Per-query times are not measured in a batch: report the average
+        const double timeSec = std::chrono::duration<double>(t1 - t0).count() /
+            static_cast<double>(std::max<size_t>(queries.size(), 1));
+        for (size_t i = 0; i < queries.size(); i++)
+            results.push_back({queries[i], std::move(paths[i]), timeSec});
+    }
+
+    return results;
+}
+
+void PrintUsage(std::ostream& out) {
+    out << "Usage: hmroute (--height <file> | --tiled <file>) [options]\n"
+           "\n"
+           "Reads one query per line (\"sx sy ex ey\") and writes the routes found.\n"
+           "\n"
+           "Options:\n"
+           "  --height <file>         Height map: PNG (8 or 16-bit), or .flt/.bil grid + .hdr\n"
+           "  --type <png>            Type map (black = forest)\n"
+           "  --tiled <file>          Tiled terrain from hmtile, mapped instead of loaded\n"
+           "  --terrain-cache <f>     Loaded terrain file, reused while the inputs match\n"
+           "  --height-scale <f>      Height scale (default 15)\n"
+           "  --water-height <f>      Water height, -1 for none (default -1)\n"
+           "  --queries <file|->      Query file, - for stdin (default -)\n"
+           "  --output <file|->       Output file, - for stdout (default -)\n"
+           "  --format <json|csv>     Output format (default json)\n"
+           "  --connectivity <4|8>    Grid connectivity (default 8)\n"
+           "  --astar                 A* search (distance based heuristic)\n"
+           "  --bidirectional         Search from both ends\n"
+           "  --queue <type>          binary, 4ary, radix or bucket (default binary)\n"
+           "  --bucket-width <f>      Cost quantization of the bucket queue (default 0.01)\n"
+           "  --threads <n>           Worker threads, 0 for all cores (default 1)\n"
+           "  --bake                  Precompute the grid edge costs before the queries (no\n"
+           "                          faster with the built-in metrics, see EdgeCostGrid)\n"
+           "  --hierarchical          Near-optimal routes over clusters (implies --bake)\n"
+           "  --cluster-size <n>      Cluster side in cells (default 32)\n"
+           "  --hierarchy-cache <f>   Hierarchy file, reused while the costs match\n"
+           "  --contraction           Exact routes over a contraction hierarchy\n"
+           "  --contraction-cache <f> Contraction hierarchy file, reused while the costs match\n"
+           "  --bridges               Allow bridges\n"
+           "  --bridge-seed <n>       Bridge sampling seed (default 0)\n"
+           "  --bridge-min <n>        Minimum bridge length (default 50)\n"
+           "  --bridge-max <n>        Maximum bridge length (default 200)\n"
+           "  --bridge-density <f>    Sampled bridge origins per cell (default 0.01)\n"
+           "  --bridge-any            Keep bridges that do not cross water\n"
+           "  --distance <w>          Distance weight (default 0.1)\n"
+           "  --slope <w>             Slope weight (default 1)\n"
+           "  --terrain <w>           Terrain weight (default 10)\n"
+           "  --timings               Print the terrain load stages to stderr\n"
+           "  --help                  Show this message\n";
+}
+
+Options ParseArgs(const int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("hmroute - Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--help") {
+            PrintUsage(std::cout);
+            std::exit(EXIT_SUCCESS);
+        } else if (arg == "--height") {
+            options.heightPath = value();
+        } else if (arg == "--type") {
+            options.typePath = value();
+        } else if (arg == "--tiled") {
+            options.tiledPath = value();
+        } else if (arg == "--terrain-cache") {
+            options.terrainCache = value();
+        } else if (arg == "--height-scale") {
+            options.heightScale = std::stof(value());
+        } else if (arg == "--water-height") {
+            options.waterHeight = std::stof(value());
+        } else if (arg == "--queries") {
+            options.queriesPath = value();
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (arg == "--format") {
+            const auto format = value();
+            if (format == "json")
+                options.format = Options::Format::JSON;
+            else if (format == "csv")
+                options.format = Options::Format::CSV;
+            else
+                throw std::runtime_error("hmroute - Unknown format: " + format);
+        } else if (arg == "--connectivity") {
+            const auto connectivity = value();
+            if (connectivity == "4")
+                options.connectivity = PathFinder::Connectivity::C4;
+            else if (connectivity == "8")
+                options.connectivity = PathFinder::Connectivity::C8;
+            else
+                throw std::runtime_error("hmroute - Unknown connectivity: " + connectivity);
+        } else if (arg == "--astar") {
+            options.searchMode = PathFinder::SearchMode::A_STAR;
+        } else if (arg == "--bidirectional") {
+            options.bidirectional = true;
+        } else if (arg == "--queue") {
+            const auto queue = value();
+            if (queue == "binary")
+                options.queueType = PathFinder::QueueType::BINARY_HEAP;
+            else if (queue == "4ary")
+                options.queueType = PathFinder::QueueType::QUATERNARY_HEAP;
+            else if (queue == "radix")
+                options.queueType = PathFinder::QueueType::RADIX_HEAP;
+            else if (queue == "bucket")
+                options.queueType = PathFinder::QueueType::BUCKET;
+            else
+                throw std::runtime_error("hmroute - Unknown queue: " + queue);
+        } else if (arg == "--bucket-width") {
+            options.bucketWidth = std::stof(value());
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--bake") {
+            options.bakeEdgeCosts = true;
+        } else if (arg == "--hierarchical") {
+            options.hierarchical = true;
+        } else if (arg == "--cluster-size") {
+            options.hierarchySettings.clusterSize = std::stoi(value());
+        } else if (arg == "--hierarchy-cache") {
+            options.hierarchyCache = value();
+        } else if (arg == "--contraction") {
+            options.contraction = true;
+        } else if (arg == "--contraction-cache") {
+            options.contractionCache = value();
+        } else if (arg == "--bridges") {
+            options.allowBridges = true;
+        } else if (arg == "--bridge-seed") {
+            options.bridgeSettings.seed = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--bridge-min") {
+            options.bridgeSettings.minLength = std::stoi(value());
+        } else if (arg == "--bridge-max") {
+            options.bridgeSettings.maxLength = std::stoi(value());
+        } else if (arg == "--bridge-density") {
+            options.bridgeSettings.sampleDensity = std::stof(value());
+        } else if (arg == "--bridge-any") {
+            options.bridgeSettings.crossWaterOnly = false;
+        } else if (arg == "--distance") {
+            options.distanceWeight = std::stof(value());
+        } else if (arg == "--slope") {
+            options.slopeWeight = std::stof(value());
+        } else if (arg == "--terrain") {
+            options.terrainWeight = std::stof(value());
+        } else if (arg == "--timings") {
+            options.timings = true;
+        } else {
+            PrintUsage(std::cerr);
+            throw std::runtime_error("hmroute - Unknown argument: " + arg);
+        }
+    }
+
+    if (options.heightPath.empty() == options.tiledPath.empty()) {
+        PrintUsage(std::cerr);
+        throw std::runtime_error("hmroute - Expected one of --height or --tiled");
+    }
+
+    // The bridges are generated from a loaded terrain
+    if (!options.tiledPath.empty() && options.allowBridges) {
+        PrintUsage(std::cerr);
+        throw std::runtime_error("hmroute - --tiled does not support bridges");
+    }
+
+    if (options.hierarchical && (options.allowBridges || options.bidirectional)) {
+        PrintUsage(std::cerr);
+        throw std::runtime_error("hmroute - --hierarchical supports neither bridges nor "
+                                 "--bidirectional");
+    }
+
+    if (options.contraction && (options.allowBridges || options.hierarchical)) {
+        PrintUsage(std::cerr);
+        throw std::runtime_error("hmroute - --contraction supports neither bridges nor "
+                                 "--hierarchical");
+    }
+
+    return options;
+}
+
+std::vector<Query> ReadQueries(std::istream& in) {
+    std::vector<Query> queries;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        Query q;
+        if (!(ss >> q.start.x >> q.start.y >> q.end.x >> q.end.y))
+            throw std::runtime_error("hmroute - Malformed query at line " +
+                                     std::to_string(lineNumber));
+        queries.push_back(q);
+    }
+    return queries;
+}
+
+void WriteJSON(std::ostream& out, const std::vector<Result>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& [query, path, timeSec] = results[i];
+
+        out << "  {\"start\": [" << query.start.x << ", " << query.start.y << "], ";
+        out << "\"end\": [" << query.end.x << ", " << query.end.y << "], ";
+        out << "\"found\": " << (path ? "true" : "false") << ", ";
+        out << "\"cost\": " << (path ? path.cost : 0.0f) << ", ";
+        out << "\"timeSec\": " << timeSec << ", ";
+        out << "\"nodesExpanded\": " << path.nodesExpanded << ", ";
+        out << "\"path\": [";
+        for (size_t j = 0; j < path.points.size(); j++) {
+            if (j > 0)
+                out << ", ";
+            out << "[" << path.points[j].x << ", " << path.points[j].y << "]";
+        }
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+void WriteCSV(std::ostream& out, const std::vector<Result>& results) {
+    out << "sx,sy,ex,ey,found,cost,time_sec,nodes_expanded,points,path\n";
+    for (const auto& [query, path, timeSec] : results) {
+        out << query.start.x << "," << query.start.y << ",";
+        out << query.end.x << "," << query.end.y << ",";
+        out << (path ? 1 : 0) << "," << (path ? path.cost : 0.0f) << "," << timeSec << ",";
+        out << path.nodesExpanded << ",";
+        out << path.points.size() << ",";
+
+        // "x:y x:y ..." keeps the path in a single column
+        for (size_t j = 0; j < path.points.size(); j++) {
+            if (j > 0)
+                out << " ";
+            out << path.points[j].x << ":" << path.points[j].y;
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "Terrain.h"
+#include "TiledTerrain.h"
+
+struct Options {
+    std::filesystem::path heightPath;
+    std::filesystem::path typePath;
+    std::filesystem::path outputPath;
+
+    float heightScale = 15.0f;
+    float waterHeight = -1.0f;
+    uint32_t tileSize = TiledTerrain::DEFAULT_TILE_SIZE;
+};
+
+static void PrintUsage(std::ostream& out);
+static Options ParseArgs(int argc, char** argv);
+
+// Converts the PNG inputs to a tiled terrain file, which hmroute --tiled maps instead of loading
+int main(const int argc, char** argv) {
+    try {
+        const Options options = ParseArgs(argc, argv);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const Terrain terrain = Terrain::Load(options.heightPath, options.typePath, {1.0f, 1.0f},
+                                              options.heightScale, options.waterHeight);
+        TiledTerrain::Write(terrain, options.outputPath, options.tileSize);
+        const auto t1 = std::chrono::steady_clock::now();
+
+        // Read back: checks the header and reports what was written
+        const auto tiled = TiledTerrain::Open(options.outputPath);
+        std::cout << options.outputPath.string() << ": " << tiled.Size().x << "x"
+                  << tiled.Size().y << ", " << tiled.TileSize() << "x" << tiled.TileSize()
+                  << " tiles, " << std::filesystem::file_size(options.outputPath) / 1024 << " KiB, "
+                  << std::chrono::duration<double>(t1 - t0).count() << " s\n";
+    } catch (std::exception& e) {
+        std::cerr << "[FATAL ERROR] " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+void PrintUsage(std::ostream& out) {
+    out << "Usage: hmtile --height <file> --output <file> [options]\n"
+           "\n"
+           "Converts a height map (and type map) to the tiled, memory-mapped terrain format.\n"
+           "\n"
+           "Options:\n"
+           "  --height <file>         Height map: PNG (8 or 16-bit), or .flt/.bil grid + .hdr\n"
+           "  --type <png>            Type map (black = forest)\n"
+           "  --height-scale <f>      Height scale (default 15)\n"
+           "  --water-height <f>      Water height, -1 for none (default -1)\n"
+           "  --output <file>         Tiled terrain file (required)\n"
+           "  --tile-size <n>         Tile side in cells, a power of two >= 64 (default 256)\n"
+           "  --help                  Show this message\n";
+}
+
+Options ParseArgs(const int argc, char** argv) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error("hmtile - Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--help") {
+            PrintUsage(std::cout);
+            std::exit(EXIT_SUCCESS);
+        } else if (arg == "--height") {
+            options.heightPath = value();
+        } else if (arg == "--type") {
+            options.typePath = value();
+        } else if (arg == "--height-scale") {
+            options.heightScale = std::stof(value());
+        } else if (arg == "--water-height") {
+            options.waterHeight = std::stof(value());
+        } else if (arg == "--output") {
+            options.outputPath = value();
+        } else if (arg == "--tile-size") {
+            options.tileSize = static_cast<uint32_t>(std::stoul(value()));
+        } else {
+            PrintUsage(std::cerr);
+            throw std::runtime_error("hmtile - Unknown argument: " + arg);
+        }
+    }
+
+    if (options.heightPath.empty() || options.outputPath.empty()) {
+        PrintUsage(std::cerr);
+        throw std::runtime_error("hmtile - Missing --height or --output");
+    }
+
+    return options;
+}
@@ -4,10 +4,15 @@ in VS_OUT {
     float height;
     vec3 normal;
     vec3 worldPos;
+    vec2 texCoord;
     flat uint type;
 } fs_in;
 
+layout(binding = 3) uniform sampler2D uCostField;
+
 uniform vec3 uLightDir = vec3(0.0, 1.0, 0.3);
+uniform int uShowCostField = 0;
+uniform float uCostFieldMax = 1.0;
 
 out vec4 FragColor;
 
@@ -22,6 +27,10 @@ const float LINE_WIDTH = 0.05;
 const float LINE_HEIGHT_THRESHOLD = 0.2;
 const float LINE_INTENSITY = 0.5;
 
+// Cost field parameters
+const float FIELD_BANDS = 20.0;
+const float FIELD_INTENSITY = 0.6;
+
 vec3 GetTerrainColor(float height, uint type) {
     vec3 baseColor = mix(vec3(0.3, 0.3, 0.35), vec3(0.6, 0.6, 0.65), height);
 
@@ -37,6 +46,20 @@ float CalculateContourLines(float height) {
     return line * lineFade;
 }
 
+// Cool (cheap) to warm (expensive), with isochrone bands. Unreached cells are left as is.
+vec3 ApplyCostField(vec3 color, vec2 texCoord) {
+    float cost = texture(uCostField, texCoord).r;
+    if (isinf(cost) || isnan(cost)) return color; // Linear filtering next to unreached cells
+
+    float t = clamp(cost / max(uCostFieldMax, 1e-6), 0.0, 1.0);
+    vec3 fieldColor = mix(vec3(0.1, 0.4, 0.9), vec3(0.95, 0.3, 0.1), t);
+
+    float band = fract(t * FIELD_BANDS);
+    fieldColor *= 0.85 + 0.15 * step(0.5, band);
+
+    return mix(color, fieldColor, FIELD_INTENSITY);
+}
+
 vec3 CalculateLighting(vec3 baseColor, vec3 normal) {
     vec3 lightDir = normalize(uLightDir);
     vec3 norm = normalize(normal);
@@ -49,6 +72,7 @@ vec3 CalculateLighting(vec3 baseColor, vec3 normal) {
 
 void main() {
     vec3 baseColor = GetTerrainColor(fs_in.height, fs_in.type);
+    if (uShowCostField != 0) baseColor = ApplyCostField(baseColor, fs_in.texCoord);
 
     vec3 litColor = CalculateLighting(baseColor, fs_in.normal);
 
@@ -14,6 +14,7 @@ out VS_OUT {
     float height;
     vec3 normal;
     vec3 worldPos;
+    vec2 texCoord;
     flat uint type;
 } vs_out;
 
@@ -27,6 +28,7 @@ void main() {
     vs_out.height = height;
     vs_out.normal = normal;
     vs_out.worldPos = worldPos;
+    vs_out.texCoord = aTexCoord;
     vs_out.type = type;
 
     gl_Position = uVP * vec4(worldPos, 1.0);
@@ -1,52 +1,145 @@
 #include "Algorithm.h"
 
-Mat<glm::vec3> Algorithm::NormalMap(const Mat<float>& heights, const float scale) {
-    const auto size = heights.Size();
-    auto normals = Mat<glm::vec3>(size);
+#include <algorithm>
+#include <stdexcept>
+
+#include "AlgorithmKernels.h"
 
-    for (int y = 0; y < size.y; y++) {
-        for (int x = 0; x < size.x; x++) {
-            const float hL = (x > 0) ? heights(x - 1, y) : heights(x, y);
-            const float hR = (x < size.x - 1) ? heights(x + 1, y) : heights(x, y);
-            const float hD = (y > 0) ? heights(x, y - 1) : heights(x, y);
-            const float hU = (y < size.y - 1) ? heights(x, y + 1) : heights(x, y);
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
 
-            auto tangent = glm::vec3(2.0f, (hR - hL) * scale, 0.0f);
-            auto bitangent = glm::vec3(0.0f, (hU - hD) * scale, 2.0f);
+using namespace Algorithm::Kernels;
 
-            const auto normal = glm::normalize(glm::cross(bitangent, tangent));
+struct RowKernels {
+    NormalRow normal;
+    GradientRow gradient;
+};
 
-            normals(x, y) = normal;
-        }
+static RowKernels SelectKernels(const Algorithm::Simd simd) {
+    switch (simd) {
+    case Algorithm::Simd::SCALAR:
+        return {NormalRowScalar, GradientRowScalar};
+#ifdef HMR_HAS_AVX2_KERNELS
+    case Algorithm::Simd::AVX2:
+        return {NormalRowAvx2, GradientRowAvx2};
+#endif
+#ifdef HMR_HAS_NEON_KERNELS
+    case Algorithm::Simd::NEON:
+        return {NormalRowNeon, GradientRowNeon};
+#endif
+    default:
+        throw std::runtime_error("Algorithm::SelectKernels() - Instruction set not built");
     }
+}
+
+static Mat<glm::vec3> NormalMap(const Mat<float>& heights,
+                                const float scale,
+                                ThreadPool* pool,
+                                const Algorithm::Simd simd) {
+    const NormalRow normalRow = SelectKernels(simd).normal;
+    const int width = static_cast<int>(heights.Width());
+    const int height = static_cast<int>(heights.Height());
+    auto normals = Mat<glm::vec3>(heights.Size());
+
+    Algorithm::ForEachRow(height, pool, [&](const int y) {
+        const float* row = &heights(0, y);
+        const float* prev = y > 0 ? row - width : row;
+        const float* next = y < height - 1 ? row + width : row;
+        normalRow(prev, row, next, width, scale, &normals(0, y));
+    });
     return normals;
 }
 
-Mat<glm::vec2> Algorithm::Gradient(const Mat<float>& in) {
-    const auto size = in.Size();
-    Mat<glm::vec2> out(size);
-
-    for (uint32_t y = 0; y < size.y; y++) {
-        for (uint32_t x = 0; x < size.x; x++) {
-            auto& o = out(x, y);
-
-            if (y == 0)
-                o.y = in(x, y) - in(x, y + 1);
-            else if (y == size.y - 1)
-                o.y = in(x, y - 1) - in(x, y);
-            else
-                o.y = in(x, y - 1) - in(x, y + 1);
-
-            if (x == 0)
-                o.x = in(x, y) - in(x + 1, y);
-            else if (x == size.x - 1)
-                o.x = in(x - 1, y) - in(x, y);
-            else
-                o.x = in(x - 1, y) - in(x + 1, y);
-
-            o *= 0.5f;
-        }
-    }
+static Mat<glm::vec2> Gradient(const Mat<float>& in, ThreadPool* pool, const Algorithm::Simd simd) {
+    const GradientRow gradientRow = SelectKernels(simd).gradient;
+    const int width = static_cast<int>(in.Width());
+    const int height = static_cast<int>(in.Height());
+    Mat<glm::vec2> out(in.Size());
 
+    Algorithm::ForEachRow(height, pool, [&](const int y) {
+        const float* row = &in(0, y);
+        const float* prev = y > 0 ? row - width : row;
+        const float* next = y < height - 1 ? row + width : row;
+        gradientRow(prev, row, next, width, &out(0, y));
+    });
     return out;
 }
+
+uint64_t Algorithm::Hash(const void* data, const size_t size, uint64_t hash) {
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+Algorithm::Simd Algorithm::DetectSimd() {
+#if defined(HMR_HAS_AVX2_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return Simd::AVX2;
+#elif defined(HMR_HAS_AVX2_KERNELS) && defined(_MSC_VER)
+    // AVX2 + FMA, and the OS saving the YMM registers
+    int info[4];
+    __cpuid(info, 1);
+    const bool fma = info[2] & (1 << 12);
+    const bool osxsave = info[2] & (1 << 27);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = info[1] & (1 << 5);
+    if (fma && osxsave && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+        return Simd::AVX2;
+#elif defined(HMR_HAS_NEON_KERNELS)
+    return Simd::NEON; // Always there on AArch64
+#endif
+    return Simd::SCALAR;
+}
+
+Mat<glm::vec3> Algorithm::NormalMap(const Mat<float>& heights, const float scale) {
+    return ::NormalMap(heights, scale, nullptr, DetectSimd());
+}
+
+Mat<glm::vec3> Algorithm::NormalMap(const Mat<float>& heights,
+                                    const float scale,
+                                    ThreadPool& pool,
+                                    const Simd simd) {
+    return ::NormalMap(heights, scale, &pool, simd);
+}
+
+Mat<glm::vec2> Algorithm::Gradient(const Mat<float>& in) {
+    return ::Gradient(in, nullptr, DetectSimd());
+}
+
+Mat<glm::vec2> Algorithm::Gradient(const Mat<float>& in, ThreadPool& pool, const Simd simd) {
+    return ::Gradient(in, &pool, simd);
+}
+
+void Algorithm::Kernels::NormalRowScalar(const float* prev,
+                                         const float* row,
+                                         const float* next,
+                                         const int width,
+                                         const float scale,
+                                         glm::vec3* out) {
+    // Borders clamped, interior without branches
+    out[0] = NormalAt(prev, row, next, width, scale, 0);
+    for (int x = 1; x < width - 1; x++)
+        out[x] = Normal(row[x - 1], row[x + 1], prev[x], next[x], scale);
+    if (width > 1)
+        out[width - 1] = NormalAt(prev, row, next, width, scale, width - 1);
+}
+
+void Algorithm::Kernels::GradientRowScalar(const float* prev,
+                                           const float* row,
+                                           const float* next,
+                                           const int width,
+                                           glm::vec2* out) {
+    out[0] = GradientAt(prev, row, next, width, 0);
+    for (int x = 1; x < width - 1; x++)
+        out[x] = {(row[x - 1] - row[x + 1]) * 0.5f, (prev[x] - next[x]) * 0.5f};
+    if (width > 1)
+        out[width - 1] = GradientAt(prev, row, next, width, width - 1);
+}
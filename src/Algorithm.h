@@ -1,11 +1,61 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
 #include "Mat.h"
+#include "ThreadPool.h"
 
 namespace Algorithm {
 
+    static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+    // 64-bit FNV-1a. Chain calls by passing the previous hash as `hash`.
+    uint64_t Hash(const void* data, size_t size, uint64_t hash = FNV_OFFSET);
+
+    template <typename T>
+    uint64_t Hash(const MatView<T>& mat, const uint64_t hash = FNV_OFFSET) {
+        const uint64_t h = Hash(&mat.Size(), sizeof(mat.Size()), hash);
+        return Hash(mat.Data(), sizeof(T) * mat.Width() * mat.Height(), h);
+    }
+
+    // Instruction sets of the image kernels
+    enum class Simd { SCALAR, AVX2, NEON };
+
+    // Best one supported by both the build and the running CPU
+    Simd DetectSimd();
+
+    // Rows per task of the pool versions: large enough to amortize the scheduling
+    static constexpr int ROW_BLOCK = 32;
+
+    // Calls rowFn(y) for every row, in blocks of ROW_BLOCK rows spread over the pool if any
+    template <typename RowFn>
+    void ForEachRow(const int height, ThreadPool* pool, const RowFn& rowFn) {
+        if (!pool) {
+            for (int y = 0; y < height; y++)
+                rowFn(y);
+            return;
+        }
+
+        const size_t blockCount = (height + ROW_BLOCK - 1) / ROW_BLOCK;
+        pool->ParallelFor(blockCount, [&](const size_t block, unsigned) {
+            const int yEnd = std::min(height, static_cast<int>(block + 1) * ROW_BLOCK);
+            for (int y = static_cast<int>(block) * ROW_BLOCK; y < yEnd; y++)
+                rowFn(y);
+        });
+    }
+
+    // Central differences, neighbors clamped at the borders.
+    // The pool versions split the rows into blocks spread over the workers.
+
     Mat<glm::vec3> NormalMap(const Mat<float>& heights, float scale);
+    Mat<glm::vec3> NormalMap(const Mat<float>& heights,
+                             float scale,
+                             ThreadPool& pool,
+                             Simd simd = DetectSimd());
 
     Mat<glm::vec2> Gradient(const Mat<float>& in);
+    Mat<glm::vec2> Gradient(const Mat<float>& in, ThreadPool& pool, Simd simd = DetectSimd());
 
 } // namespace Algorithm
@@ -0,0 +1,88 @@
+#include "AlgorithmKernels.h"
+
+#ifdef HMR_HAS_AVX2_KERNELS
+
+#include <immintrin.h>
+
+// Compiled for AVX2 whatever the target flags: only called after Algorithm::DetectSimd()
+#if defined(__GNUC__) || defined(__clang__)
+#define HMR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define HMR_TARGET_AVX2
+#endif
+
+HMR_TARGET_AVX2 void Algorithm::Kernels::NormalRowAvx2(const float* prev,
+                                                       const float* row,
+                                                       const float* next,
+                                                       const int width,
+                                                       const float scale,
+                                                       glm::vec3* out) {
+    out[0] = NormalAt(prev, row, next, width, scale, 0);
+
+    const __m256 vScale = _mm256_set1_ps(scale);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    int x = 1;
+    for (; x + 8 <= width - 1; x += 8) {
+        const __m256 hL = _mm256_loadu_ps(row + x - 1);
+        const __m256 hR = _mm256_loadu_ps(row + x + 1);
+        const __m256 hD = _mm256_loadu_ps(prev + x);
+        const __m256 hU = _mm256_loadu_ps(next + x);
+
+        const __m256 tx = _mm256_mul_ps(_mm256_sub_ps(hR, hL), vScale);
+        const __m256 tz = _mm256_mul_ps(_mm256_sub_ps(hU, hD), vScale);
+        const __m256 length2 = _mm256_fmadd_ps(tx, tx, _mm256_fmadd_ps(tz, tz, four));
+        const __m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(length2));
+
+        alignas(32) float nx[8], ny[8], nz[8];
+        _mm256_store_ps(nx, _mm256_xor_ps(_mm256_mul_ps(tx, invLength), signBit));
+        _mm256_store_ps(ny, _mm256_mul_ps(two, invLength));
+        _mm256_store_ps(nz, _mm256_xor_ps(_mm256_mul_ps(tz, invLength), signBit));
+
+        // vec3 is packed: interleave through the stack
+        for (int i = 0; i < 8; i++)
+            out[x + i] = {nx[i], ny[i], nz[i]};
+    }
+
+    for (; x < width - 1; x++)
+        out[x] = Normal(row[x - 1], row[x + 1], prev[x], next[x], scale);
+    if (width > 1)
+        out[width - 1] = NormalAt(prev, row, next, width, scale, width - 1);
+}
+
+HMR_TARGET_AVX2 void Algorithm::Kernels::GradientRowAvx2(const float* prev,
+                                                         const float* row,
+                                                         const float* next,
+                                                         const int width,
+                                                         glm::vec2* out) {
+    out[0] = GradientAt(prev, row, next, width, 0);
+
+    const __m256 half = _mm256_set1_ps(0.5f);
+    auto* dst = reinterpret_cast<float*>(out);
+
+    int x = 1;
+    for (; x + 8 <= width - 1; x += 8) {
+        const __m256 l = _mm256_loadu_ps(row + x - 1);
+        const __m256 r = _mm256_loadu_ps(row + x + 1);
+        const __m256 d = _mm256_loadu_ps(prev + x);
+        const __m256 u = _mm256_loadu_ps(next + x);
+        const __m256 gx = _mm256_mul_ps(_mm256_sub_ps(l, r), half);
+        const __m256 gy = _mm256_mul_ps(_mm256_sub_ps(d, u), half);
+
+        // (x0 y0 x1 y1 | x4 y4 x5 y5) and (x2 y2 x3 y3 | x6 y6 x7 y7) -> 16 interleaved floats
+        const __m256 lo = _mm256_unpacklo_ps(gx, gy);
+        const __m256 hi = _mm256_unpackhi_ps(gx, gy);
+        _mm256_storeu_ps(dst + 2 * x, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2 * x + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    for (; x < width - 1; x++)
+        out[x] = {(row[x - 1] - row[x + 1]) * 0.5f, (prev[x] - next[x]) * 0.5f};
+    if (width > 1)
+        out[width - 1] = GradientAt(prev, row, next, width, width - 1);
+}
+
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+// Row kernels behind Algorithm::NormalMap() and Algorithm::Gradient(). `prev` and `next`
+// are the rows above and below `row`, or `row` itself on the first and last rows. Each
+// kernel does the border columns in scalar and the interior in vectors.
+namespace Algorithm::Kernels {
+
+    // glm::normalize(cross(bitangent, tangent)) of the central differences, simplified
+    inline glm::vec3 Normal(const float hL,
+                            const float hR,
+                            const float hD,
+                            const float hU,
+                            const float scale) {
+        const float tx = (hR - hL) * scale;
+        const float tz = (hU - hD) * scale;
+        const float invLength = 1.0f / std::sqrt(tx * tx + tz * tz + 4.0f);
+        return {-tx * invLength, 2.0f * invLength, -tz * invLength};
+    }
+
+    // Clamped column x of a row
+    inline glm::vec3 NormalAt(const float* prev,
+                              const float* row,
+                              const float* next,
+                              const int width,
+                              const float scale,
+                              const int x) {
+        const float hL = row[x > 0 ? x - 1 : x];
+        const float hR = row[x < width - 1 ? x + 1 : x];
+        return Normal(hL, hR, prev[x], next[x], scale);
+    }
+
+    inline glm::vec2 GradientAt(const float* prev,
+                                const float* row,
+                                const float* next,
+                                const int width,
+                                const int x) {
+        const float l = row[x > 0 ? x - 1 : x];
+        const float r = row[x < width - 1 ? x + 1 : x];
+        return {(l - r) * 0.5f, (prev[x] - next[x]) * 0.5f};
+    }
+
+    using NormalRow = void (*)(const float* prev,
+                               const float* row,
+                               const float* next,
+                               int width,
+                               float scale,
+                               glm::vec3* out);
+
+    using GradientRow = void (*)(const float* prev,
+                                 const float* row,
+                                 const float* next,
+                                 int width,
+                                 glm::vec2* out);
+
+    void NormalRowScalar(const float* prev,
+                         const float* row,
+                         const float* next,
+                         int width,
+                         float scale,
+                         glm::vec3* out);
+    void GradientRowScalar(const float* prev,
+                           const float* row,
+                           const float* next,
+                           int width,
+                           glm::vec2* out);
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HMR_HAS_AVX2_KERNELS
+    void NormalRowAvx2(const float* prev,
+                       const float* row,
+                       const float* next,
+                       int width,
+                       float scale,
+                       glm::vec3* out);
+    void GradientRowAvx2(const float* prev,
+                         const float* row,
+                         const float* next,
+                         int width,
+                         glm::vec2* out);
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define HMR_HAS_NEON_KERNELS
+    void NormalRowNeon(const float* prev,
+                       const float* row,
+                       const float* next,
+                       int width,
+                       float scale,
+                       glm::vec3* out);
+    void GradientRowNeon(const float* prev,
+                         const float* row,
+                         const float* next,
+                         int width,
+                         glm::vec2* out);
+#endif
+
+} // namespace Algorithm::Kernels
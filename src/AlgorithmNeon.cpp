@@ -0,0 +1,67 @@
+#include "AlgorithmKernels.h"
+
+#ifdef HMR_HAS_NEON_KERNELS
+
+#include <arm_neon.h>
+
+void Algorithm::Kernels::NormalRowNeon(const float* prev,
+                                       const float* row,
+                                       const float* next,
+                                       const int width,
+                                       const float scale,
+                                       glm::vec3* out) {
+    out[0] = NormalAt(prev, row, next, width, scale, 0);
+
+    const float32x4_t four = vdupq_n_f32(4.0f);
+    const float32x4_t two = vdupq_n_f32(2.0f);
+    auto* dst = reinterpret_cast<float*>(out);
+
+    int x = 1;
+    for (; x + 4 <= width - 1; x += 4) {
+        const float32x4_t tx = vmulq_n_f32(vsubq_f32(vld1q_f32(row + x + 1),
+                                                     vld1q_f32(row + x - 1)),
+                                           scale);
+        const float32x4_t tz = vmulq_n_f32(vsubq_f32(vld1q_f32(next + x), vld1q_f32(prev + x)),
+                                           scale);
+        const float32x4_t length2 = vfmaq_f32(vfmaq_f32(four, tz, tz), tx, tx);
+        const float32x4_t invLength = vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(length2));
+
+        // vec3 is packed: the structure store interleaves x, y, z
+        float32x4x3_t normal;
+        normal.val[0] = vnegq_f32(vmulq_f32(tx, invLength));
+        normal.val[1] = vmulq_f32(two, invLength);
+        normal.val[2] = vnegq_f32(vmulq_f32(tz, invLength));
+        vst3q_f32(dst + 3 * x, normal);
+    }
+
+    for (; x < width - 1; x++)
+        out[x] = Normal(row[x - 1], row[x + 1], prev[x], next[x], scale);
+    if (width > 1)
+        out[width - 1] = NormalAt(prev, row, next, width, scale, width - 1);
+}
+
+void Algorithm::Kernels::GradientRowNeon(const float* prev,
+                                         const float* row,
+                                         const float* next,
+                                         const int width,
+                                         glm::vec2* out) {
+    out[0] = GradientAt(prev, row, next, width, 0);
+
+    auto* dst = reinterpret_cast<float*>(out);
+
+    int x = 1;
+    for (; x + 4 <= width - 1; x += 4) {
+        float32x4x2_t gradient;
+        gradient.val[0] =
+            vmulq_n_f32(vsubq_f32(vld1q_f32(row + x - 1), vld1q_f32(row + x + 1)), 0.5f);
+        gradient.val[1] = vmulq_n_f32(vsubq_f32(vld1q_f32(prev + x), vld1q_f32(next + x)), 0.5f);
+        vst2q_f32(dst + 2 * x, gradient);
+    }
+
+    for (; x < width - 1; x++)
+        out[x] = {(row[x - 1] - row[x + 1]) * 0.5f, (prev[x] - next[x]) * 0.5f};
+    if (width > 1)
+        out[width - 1] = GradientAt(prev, row, next, width, width - 1);
+}
+
+#endif
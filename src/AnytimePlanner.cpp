@@ -0,0 +1,204 @@
+#include "AnytimePlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+    constexpr float INF = std::numeric_limits<float>::infinity();
+    constexpr auto& STEPS = EdgeCostGrid::DIRECTIONS;
+
+    // Expansions between two deadline checks
+    constexpr size_t CHECK_INTERVAL = 256;
+
+    // Min-heap on f
+    constexpr auto LATER = [](const auto& a, const auto& b) { return a.f > b.f; };
+
+} // namespace
+
+void AnytimePlanner::Start(std::shared_ptr<const EdgeCostGrid> edgeCosts,
+                           const PathFinder::Connectivity c,
+                           const float scale,
+                           const glm::ivec2& from,
+                           const glm::ivec2& to) {
+    grid = std::move(edgeCosts);
+    size = grid ? grid->Size() : glm::ivec2(0);
+    connectivity = c;
+    heuristicScale = scale;
+    start = from;
+    goal = to;
+
+    best = {};
+    bound = 1.0f;
+    nodesExpanded = 0;
+    elapsedSec = 0.0;
+    done = !grid || !InBounds(start) || !InBounds(goal);
+    if (done)
+        return;
+
+    const size_t cellCount = static_cast<size_t>(size.x) * size.y;
+    g.assign(cellCount, INF);
+    parents.assign(cellCount, -1);
+    closed.assign(cellCount, 0);
+    incons.assign(cellCount, 0);
+    inconsistent.clear();
+    open.clear();
+
+    epsilon = std::max(settings.initialEpsilon, 1.0f);
+    pass = 1;
+    g[Index(start)] = 0.0f;
+    Push(Index(start));
+}
+
+bool AnytimePlanner::Improve(const double budgetSec) {
+    if (done)
+        return false;
+
+    using Clock = std::chrono::steady_clock;
+    const auto begin = Clock::now();
+    const auto deadline = begin + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(budgetSec));
+
+    bool improved = false;
+    while (ImprovePath(deadline)) {
+        const float previousCost = best ? best.cost : INF;
+        Publish();
+        improved |= best && best.cost < previousCost;
+
+        // Optimal, or no path at all: a lower epsilon cannot change that
+        if (epsilon <= 1.0f || !best) {
+            bound = 1.0f;
+            done = true;
+            break;
+        }
+
+        NextPass();
+        if (Clock::now() >= deadline)
+            break;
+    }
+
+    best.nodesExpanded = nodesExpanded;
+    elapsedSec += std::chrono::duration<double>(Clock::now() - begin).count();
+    return improved;
+}
+
+void AnytimePlanner::Reset() {
+    done = true;
+}
+
+bool AnytimePlanner::InBounds(const glm::ivec2& cell) const {
+    return cell.x >= 0 && cell.x < size.x && cell.y >= 0 && cell.y < size.y;
+}
+
+float AnytimePlanner::Heuristic(const int i) const {
+    const glm::ivec2 cell = Cell(i);
+    const float dx = static_cast<float>(std::abs(cell.x - goal.x));
+    const float dy = static_cast<float>(std::abs(cell.y - goal.y));
+
+    if (connectivity == PathFinder::Connectivity::C4)
+        return heuristicScale * (dx + dy); // Manhattan
+    return heuristicScale * (std::max(dx, dy) + (1.41421356f - 1.0f) * std::min(dx, dy));
+}
+
+void AnytimePlanner::Push(const int i) {
+    open.push_back({g[i] + epsilon * Heuristic(i), g[i], i});
+    std::ranges::push_heap(open, LATER);
+}
+
+bool AnytimePlanner::ImprovePath(const std::chrono::steady_clock::time_point deadline) {
+    const int goalIndex = Index(goal);
+    size_t expanded = 0;
+
+    while (!open.empty()) {
+        const Entry top = open.front();
+        if (top.g != g[top.cell] || closed[top.cell] == pass) {
+            std::ranges::pop_heap(open, LATER);
+            open.pop_back();
+            continue;
+        }
+
+        // No open cell can lead to a cheaper goal at this epsilon
+        if (g[goalIndex] <= top.f)
+            return true;
+
+        std::ranges::pop_heap(open, LATER);
+        open.pop_back();
+        closed[top.cell] = pass;
+        nodesExpanded++;
+
+        const glm::ivec2 cell = Cell(top.cell);
+        for (int dir = 0; dir < static_cast<int>(connectivity); dir++) {
+            const glm::ivec2 next = cell + glm::ivec2(STEPS[dir].dx, STEPS[dir].dy);
+            if (!InBounds(next))
+                continue;
+
+            const int n = Index(next);
+            const float cost = top.g + (*grid)(cell.x, cell.y, dir);
+            if (!(cost < g[n]))
+                continue;
+
+            g[n] = cost;
+            parents[n] = top.cell;
+
+            // Expanded cells are not reopened within a pass: kept for the next one
+            if (closed[n] != pass) {
+                Push(n);
+            } else if (!incons[n]) {
+                incons[n] = 1;
+                inconsistent.push_back(n);
+            }
+        }
+
+        if (++expanded % CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline)
+            return false;
+    }
+    return true;
+}
+
+void AnytimePlanner::NextPass() {
+    epsilon = std::max(epsilon - settings.epsilonStep, 1.0f);
+
+    // The open cells, then the inconsistent ones, with the new epsilon. Nothing is closed.
+    std::vector<Entry> reopened;
+    reopened.reserve(open.size() + inconsistent.size());
+    for (const auto& [f, cost, cell] : open) {
+        if (cost == g[cell] && closed[cell] != pass)
+            reopened.push_back({cost + epsilon * Heuristic(cell), cost, cell});
+    }
+    for (const int cell : inconsistent) {
+        reopened.push_back({g[cell] + epsilon * Heuristic(cell), g[cell], cell});
+        incons[cell] = 0;
+    }
+    inconsistent.clear();
+
+    open = std::move(reopened);
+    std::ranges::make_heap(open, LATER);
+    pass++;
+}
+
+void AnytimePlanner::Publish() {
+    const int goalIndex = Index(goal);
+    if (std::isinf(g[goalIndex])) {
+        best = {};
+        return;
+    }
+
+    best = {};
+    for (int p = goalIndex; p != -1; p = parents[p])
+        best.points.emplace_back(Cell(p));
+    std::ranges::reverse(best.points);
+    best.cost = g[goalIndex];
+
+    // Every cheaper path goes through an open or inconsistent cell, whose g + h (no epsilon)
+    // is a lower bound of it
+    float lowest = INF;
+    for (const auto& [f, cost, cell] : open) {
+        if (cost == g[cell] && closed[cell] != pass)
+            lowest = std::min(lowest, cost + Heuristic(cell));
+    }
+    for (const int cell : inconsistent)
+        lowest = std::min(lowest, g[cell] + Heuristic(cell));
+
+    bound = std::clamp(best.cost / lowest, 1.0f, epsilon);
+}
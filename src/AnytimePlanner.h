@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EdgeCostGrid.h"
+#include "PathFinder.h"
+
+// ARA* (anytime repairing A*) over the C4/C8 grid of an EdgeCostGrid, for a route that must show
+// up at once and may improve afterwards. The first pass is a weighted A* (heuristic inflated by
+// epsilon), which finds a path after a fraction of the expansions. Each following pass lowers
+// epsilon and only reopens the cells whose cost improved since they were expanded, until
+// epsilon reaches 1: the path is then optimal. Improve() runs within a time budget and resumes
+// where it stopped, e.g. a few milliseconds per frame.
+//
+// Bridges are not part of the graph. The heuristic must be a lower bound of the edge costs,
+// as with PathFinder::SetHeuristicScale().
+class AnytimePlanner {
+public:
+    struct Settings {
+        float initialEpsilon = 3.0f;
+        float epsilonStep = 0.5f; // Subtracted after each pass, down to 1
+    };
+
+    AnytimePlanner() = default;
+    explicit AnytimePlanner(const Settings& settings) : settings(settings) {}
+
+    // New query: drops the previous search and its path
+    void Start(std::shared_ptr<const EdgeCostGrid> grid,
+               PathFinder::Connectivity connectivity,
+               float heuristicScale,
+               const glm::ivec2& start,
+               const glm::ivec2& goal);
+
+    // Searches for about `budgetSec` (checked every few hundred expansions).
+    // True if Best() improved.
+    bool Improve(double budgetSec);
+    // Drops the search: Done() until the next Start()
+    void Reset();
+
+    // Cheapest path found so far, nodesExpanded counting every pass
+    const PathFinder::Path& Best() const { return best; }
+    // Best().cost is at most Bound() times the optimal cost. 1 once Done().
+    float Bound() const { return bound; }
+    // The optimal path was found, or there is none
+    bool Done() const { return done; }
+    // Spent in Improve() since Start()
+    double ElapsedSec() const { return elapsedSec; }
+
+private:
+    // Lazy deletion: an entry is live while its cell is open with that same cost
+    struct Entry {
+        float f;
+        float g;
+        int cell;
+    };
+
+    bool InBounds(const glm::ivec2& cell) const;
+    int Index(const glm::ivec2& cell) const { return cell.y * size.x + cell.x; }
+    glm::ivec2 Cell(const int i) const { return {i % size.x, i / size.x}; }
+    float Heuristic(int i) const;
+
+    void Push(int i);
+    // Expands until the goal cannot improve in this pass (true) or the deadline (false)
+    bool ImprovePath(std::chrono::steady_clock::time_point deadline);
+    // Lowers epsilon, moves the inconsistent cells back to the open list and reorders it
+    void NextPass();
+    // Publishes the path to the goal and the bound of the pass
+    void Publish();
+
+private:
+    std::shared_ptr<const EdgeCostGrid> grid;
+    glm::ivec2 size = {0, 0};
+    PathFinder::Connectivity connectivity = PathFinder::Connectivity::C8;
+    float heuristicScale = 0.0f;
+    glm::ivec2 start = {-1, -1};
+    glm::ivec2 goal = {-1, -1};
+    Settings settings;
+
+    float epsilon = 1.0f;
+    uint32_t pass = 0;
+    std::vector<float> g;
+    std::vector<int> parents;
+    std::vector<uint32_t> closed;  // Pass in which the cell was expanded
+    std::vector<uint8_t> incons;   // Improved after its expansion in this pass
+    std::vector<int> inconsistent; // The cells flagged in `incons`
+    std::vector<Entry> open;       // Heap on f
+
+    PathFinder::Path best;
+    float bound = 1.0f;
+    bool done = true;
+    size_t nodesExpanded = 0;
+    double elapsedSec = 0.0;
+};
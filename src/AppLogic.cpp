@@ -1,16 +1,17 @@
 #include "AppLogic.h"
 
-#include <future>
+#include <cmath>
+#include <limits>
 #include <ranges>
 
 #include <glm/gtc/type_ptr.hpp>
 
-#include "Algorithm.h"
 #include "Core/App.h"
 #include "Core/Camera/FreeCamera.h"
 #include "Core/Utils.h"
 #include "Metric.h"
 #include "PathFinder.h"
+#include "TerrainCache.h"
 #include "UI.h"
 
 template <>
@@ -21,12 +22,17 @@ Texture Texture::From<Terrain::TileType>(const Mat<Terrain::TileType>& mat) {
 AppLogic::AppLogic() {
     camera = FreeCamera::Create(glm::vec3(50.f), glm::vec3{0.0f, -1.0f, 0.01f}, 90.f);
 
-    terrain = Terrain::Load(DATA_DIR "Terrain/River.png",     //
-                            DATA_DIR "Terrain/RiverType.png", //
-                            {100.0f, 100.0f},                 // worldSize
-                            15.0f,                            // heightScale
-                            3.0f                              // waterHeight
+    // Decoded and classified, and its normals computed, on the first launch only
+    const auto cachePath = std::filesystem::temp_directory_path() / "hmr_river.terrain";
+    auto cached = TerrainCache::LoadOrBuild(cachePath,
+                                            DATA_DIR "Terrain/River.png",     //
+                                            DATA_DIR "Terrain/RiverType.png", //
+                                            pool,
+                                            {100.0f, 100.0f}, // worldSize
+                                            15.0f,            // heightScale
+                                            3.0f              // waterHeight
     );
+    terrain = std::move(cached.terrain);
 
     // --- Render ---
     waterProgram = Program::FromFile(DATA_DIR "Shaders/Water.vert", DATA_DIR "Shaders/Water.frag");
@@ -35,9 +41,8 @@ AppLogic::AppLogic() {
     lineProgram = Program::FromFile(DATA_DIR "Shaders/Line.vert", DATA_DIR "Shaders/Line.frag");
     flagProgram = Program::FromFile(DATA_DIR "Shaders/Flag.vert", DATA_DIR "Shaders/Flag.frag");
 
-    const auto normals = Algorithm::NormalMap(terrain.heightMap, terrain.heightScale);
     heightTex = Texture::From(terrain.heightMap);
-    normalTex = Texture::From(normals);
+    normalTex = Texture::From(cached.normals);
     typeTex = Texture::From(terrain.typeMap);
 
     flagMesh = Mesh::FromFile(DATA_DIR "Models/Flag.obj");
@@ -56,6 +61,110 @@ void AppLogic::UpdateFlagTransforms() {
     flagTransforms[FLAG_END].Translate(terrain.GridToWorld(end.x, end.y));
 }
 
+AppLogic::Metrics AppLogic::CurrentMetrics() const {
+    return {
+        PathFinder::Weighted{distanceWeight, Metric::DistanceCost{}},
+        PathFinder::Weighted{slopeWeight,
+                             Metric::SlopeCost{terrain.heightMap, terrain.heightScale}},
+        PathFinder::Weighted{terrainWeight, Metric::TerrainCost{terrain.typeMap}},
+    };
+}
+
+std::shared_ptr<const EdgeCostGrid> AppLogic::EdgeCosts(const bool bake,
+                                                        const Metrics& metrics,
+                                                        const std::stop_token& stop) {
+    if (!bake)
+        return nullptr;
+
+    // Rebuilt only when the weights or the terrain changed. A pre-empted job stops within
+    // a row of the bake.
+    const auto& [distance, slope, type] = metrics;
+    return edgeCostCache.Get(terrain.dimensions, pool, stop, distance, slope, type);
+}
+
+PathFinder AppLogic::CurrentFinder() const {
+    PathFinder finder;
+    finder.From(start.x, start.y)
+        .To(end.x, end.y)
+        .Size(terrain.heightMap.Width(), terrain.heightMap.Height())
+        .SetConnectivity(connectivity)
+        .SetSearchMode(searchMode)
+        .SetHeuristicScale(Metric::DistanceCost::HeuristicScale(distanceWeight))
+        .SetBidirectional(bidirectional)
+        .AllowBridges(allowBridges)
+        .SetBridges(bridges);
+    return finder;
+}
+
+void AppLogic::Replan() {
+    fieldJob.Cancel();
+    ResetAnytime();
+
+    // A pre-empted replan leaves the planner valid: the next one resumes its repair
+    pathJob.Start([this, start = start, end = end, metrics = CurrentMetrics(),
+                   connectivity = connectivity,
+                   scale = Metric::DistanceCost::HeuristicScale(distanceWeight)](
+                      const std::stop_token& stop, const auto&) {
+        planner.SetConnectivity(connectivity);
+        planner.SetHeuristicScale(scale);
+        auto grid = EdgeCosts(true, metrics, stop);
+        if (!grid) {
+            PathFinder::Path stopped;
+            stopped.stopped = true;
+            return stopped;
+        }
+
+        planner.SetEdgeCosts(std::move(grid));
+        planner.SetStart(start);
+        planner.SetGoal(end);
+        return planner.Plan(stop);
+    });
+}
+
+void AppLogic::StartAnytime() {
+    // The edge cost cache is shared with the jobs
+    pathJob.Cancel();
+    fieldJob.Cancel();
+    anytime.Reset();
+
+    // Off the main thread: a weight change rebakes the whole grid (19 ms on River, 29 ms on
+    // AlpsMontBlanc with one core), and the next change pre-empts it
+    bakeJob.Start([this, metrics = CurrentMetrics()](const std::stop_token& stop, const auto&) {
+        return EdgeCosts(true, metrics, stop);
+    });
+}
+
+void AppLogic::ResetAnytime() {
+    bakeJob.Cancel();
+    anytime.Reset();
+}
+
+void AppLogic::UploadPath() {
+    if (!path)
+        return;
+
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+
+    vertices.reserve(path.points.size() * 3);
+    indices.reserve((path.points.size() - 1) * 2);
+
+    for (const auto& p : path.points) {
+        glm::vec3 w = terrain.GridToWorldAboveWater(p.x, p.y);
+        w.y += 0.2f;
+
+        vertices.push_back(w.x);
+        vertices.push_back(w.y);
+        vertices.push_back(w.z);
+    }
+
+    for (size_t i = 0; i < path.points.size() - 1; ++i) {
+        indices.push_back(static_cast<uint32_t>(i));
+        indices.push_back(static_cast<uint32_t>(i + 1));
+    }
+
+    pathMesh.SetVertices(std::move(vertices)).SetIndices(std::move(indices)).Upload();
+}
 
 void AppLogic::Update(const float dt) {
     const auto& window = App::GetWindow();
@@ -73,6 +182,8 @@ void AppLogic::Update(const float dt) {
 
     terrainProgram.SetUniform("uVP", vp);
     terrainProgram.SetUniform("uHeightScale", terrain.heightScale);
+    terrainProgram.SetUniform("uShowCostField", showCostField && costField ? 1 : 0);
+    terrainProgram.SetUniform("uCostFieldMax", costFieldMax);
 
     if (terrain.waterHeight != -1.f) {
         waterProgram.SetUniform("uVP", vp);
@@ -82,36 +193,46 @@ void AppLogic::Update(const float dt) {
     lineProgram.SetUniform("uVP", vp);
     flagProgram.SetUniform("uVP", vp);
 
-    if (jobRunning &&
-        pendingJob.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-        path = pendingJob.get();
-        jobTimeSec = App::Time() - jobTimeStartSec;
-
-        if (path) {
-            std::vector<float> vertices;
-            std::vector<uint32_t> indices;
+    // Any change of the settings since restarted the bake: these are still those it is for
+    if (auto grid = bakeJob.Poll(); grid && *grid) {
+        anytime.Start(std::move(*grid), connectivity,
+                      Metric::DistanceCost::HeuristicScale(distanceWeight), start, end);
+    }
 
-            vertices.reserve(path.points.size() * 3);
-            indices.reserve((path.points.size() - 1) * 2);
+    // A slice of the anytime search: a first route within a frame, then better ones
+    if (!anytime.Done()) {
+        const bool improved = anytime.Improve(frameBudgetMs * 1e-3);
+        pathBound = anytime.Bound();
+        jobTimeSec = anytime.ElapsedSec();
+        if (improved || anytime.Done()) {
+            path = anytime.Best();
+            UploadPath();
+        }
+    }
 
-            for (const auto& p : path.points) {
-                glm::vec3 w = terrain.GridToWorldAboveWater(p.x, p.y);
-                w.y += 0.2f;
+    if (auto result = pathJob.Poll()) {
+        path = std::move(*result);
+        pathBound = 1.0f;
+        jobTimeSec = pathJob.ElapsedSec();
 
-                vertices.push_back(w.x);
-                vertices.push_back(w.y);
-                vertices.push_back(w.z);
-            }
+        UploadPath();
+    }
 
-            for (size_t i = 0; i < path.points.size() - 1; ++i) {
-                indices.push_back(static_cast<uint32_t>(i));
-                indices.push_back(static_cast<uint32_t>(i + 1));
-            }
+    if (auto result = fieldJob.Poll()) {
+        costField = std::move(*result);
+        jobTimeSec = fieldJob.ElapsedSec();
 
-            pathMesh.SetVertices(std::move(vertices)).SetIndices(std::move(indices)).Upload();
+        costFieldMax = 0.0f;
+        for (uint32_t i = 0; i < costField.costs.Width() * costField.costs.Height(); i++) {
+            const float cost = costField.costs.Data()[i];
+            if (!std::isinf(cost))
+                costFieldMax = std::max(costFieldMax, cost);
         }
 
-        jobRunning = false;
+        // Unreached cells stay infinite in the texture, the shader leaves them untinted
+        if (costField)
+            costFieldTex = Texture::From(costField.costs);
+        showCostField = true;
     }
 }
 
@@ -123,6 +244,8 @@ void AppLogic::Render() {
     heightTex.Bind(0);
     normalTex.Bind(1);
     typeTex.Bind(2);
+    if (showCostField && costField)
+        costFieldTex.Bind(3);
 
     terrainProgram.Bind();
     terrainMesh.Draw();
@@ -179,6 +302,17 @@ void AppLogic::UI() {
     ImGui::NewLine();
 
     ImGui::Checkbox("Bridges", &allowBridges);
+    if (allowBridges && ImGui::TreeNode("Bridge settings")) {
+        ImGui::InputScalar("Seed", ImGuiDataType_U32, &bridgeSettings.seed);
+        ImGui::InputInt("Min length", &bridgeSettings.minLength);
+        bridgeSettings.minLength = std::max(bridgeSettings.minLength, 1);
+        ImGui::InputInt("Max length", &bridgeSettings.maxLength);
+        bridgeSettings.maxLength = std::max(bridgeSettings.maxLength, bridgeSettings.minLength);
+        ImGui::InputFloat("Density", &bridgeSettings.sampleDensity, 0.0f, 0.0f, "%.4f");
+        bridgeSettings.sampleDensity = std::max(bridgeSettings.sampleDensity, 0.0f);
+        ImGui::Checkbox("Cross water only", &bridgeSettings.crossWaterOnly);
+        ImGui::TreePop();
+    }
 
     int connectivityIndex = (connectivity == PathFinder::Connectivity::C4) ? 0 : 1;
     ImGui::Combo("Connectivity", &connectivityIndex, CONNECTIVITY_NAMES,
@@ -186,6 +320,25 @@ void AppLogic::UI() {
     connectivity =
         (connectivityIndex == 0) ? PathFinder::Connectivity::C4 : PathFinder::Connectivity::C8;
 
+    int searchModeIndex = (searchMode == PathFinder::SearchMode::DIJKSTRA) ? 0 : 1;
+    ImGui::Combo("Search", &searchModeIndex, SEARCH_MODE_NAMES, std::size(SEARCH_MODE_NAMES));
+    searchMode =
+        (searchModeIndex == 0) ? PathFinder::SearchMode::DIJKSTRA : PathFinder::SearchMode::A_STAR;
+    ImGui::Checkbox("Bidirectional", &bidirectional);
+    ImGui::Checkbox("Bake edge costs", &bakeEdgeCosts);
+    if (!allowBridges) {
+        int liveModeIndex = static_cast<int>(liveMode);
+        // Another mode replans even if nothing else changed
+        if (ImGui::Combo("Live replanning", &liveModeIndex, LIVE_MODE_NAMES,
+                         std::size(LIVE_MODE_NAMES)))
+            plannedSettings = {};
+        liveMode = static_cast<LiveMode>(liveModeIndex);
+        if (liveMode == LiveMode::ANYTIME) {
+            ImGui::InputFloat("Frame budget (ms)", &frameBudgetMs);
+            frameBudgetMs = std::max(frameBudgetMs, 0.1f);
+        }
+    }
+
     ImGui::NewLine();
 
     ImGui::Text("Weights");
@@ -197,25 +350,97 @@ void AppLogic::UI() {
     terrainWeight = std::max(terrainWeight, 0.0f);
     ImGui::NewLine();
 
-    if (ImGui::ComputeButton("Compute", jobRunning)) {
-        jobRunning = true;
-        pendingJob = std::async(std::launch::async, [&]() -> PathFinder::Path {
-            jobTimeStartSec = App::Time();
-            return PathFinder()
-                .From(start.x, start.y)
-                .To(end.x, end.y)
-                .Size(terrain.heightMap.Width(), terrain.heightMap.Height())
-                .SetConnectivity(connectivity)
-                .AllowBridges(allowBridges)
-                .With(distanceWeight, Metric::Distance())
-                .With(slopeWeight, Metric::Slope(terrain.heightMap, terrain.heightScale))
-                .With(terrainWeight, Metric::Terrain(terrain.typeMap))
-                .Compute();
+    // Only repairs the last route, or only searches for a frame: it can run on every frame
+    // something changed
+    const LiveSettings settings(start, end, distanceWeight, slopeWeight, terrainWeight,
+                                connectivity);
+    const bool live = liveMode != LiveMode::OFF && !allowBridges;
+    if (live && settings != plannedSettings) {
+        plannedSettings = settings;
+        if (liveMode == LiveMode::ANYTIME)
+            StartAnytime();
+        else
+            Replan();
+    } else if (!live) {
+        plannedSettings = {};
+    }
+    if (liveMode != LiveMode::ANYTIME || allowBridges)
+        ResetAnytime();
+
+    // Everything a job reads is copied when it starts: the settings can change meanwhile.
+    // A new request pre-empts the running one.
+    if (ImGui::ComputeButton("Compute", pathJob.Running())) {
+        // The network only depends on the terrain and its settings: reuse it between queries
+        if (allowBridges && (!bridges || bridgeSettings != builtBridgeSettings)) {
+            bridges =
+                std::make_shared<BridgeNetwork>(BridgeNetwork::Generate(terrain, bridgeSettings));
+            builtBridgeSettings = bridgeSettings;
+        }
+
+        fieldJob.Cancel();
+        ResetAnytime();
+        pathJob.Start([this, finder = CurrentFinder(), metrics = CurrentMetrics(),
+                       bake = bakeEdgeCosts](const std::stop_token& stop,
+                                             const auto& progress) mutable {
+            const auto& [distance, slope, type] = metrics;
+            return finder.SetEdgeCosts(EdgeCosts(bake, metrics, stop))
+                .SetStopToken(stop)
+                .SetProgress(progress)
+                .Compute(workspace, distance, slope, type);
         });
     }
 
+    ImGui::SameLine();
+    if (ImGui::ComputeButton("Cost field", fieldJob.Running())) {
+        pathJob.Cancel();
+        ResetAnytime();
+        const float budget =
+            costFieldBudget > 0.0f ? costFieldBudget : std::numeric_limits<float>::infinity();
+        fieldJob.Start([this, finder = CurrentFinder(), metrics = CurrentMetrics(),
+                        bake = bakeEdgeCosts, budget](const std::stop_token& stop,
+                                                      const auto& progress) mutable {
+            const auto& [distance, slope, type] = metrics;
+            return finder.SetEdgeCosts(EdgeCosts(bake, metrics, stop))
+                .SetStopToken(stop)
+                .SetProgress(progress)
+                .ComputeField(budget, distance, slope, type);
+        });
+    }
+    ImGui::InputFloat("Budget (0 = all)", &costFieldBudget);
+    costFieldBudget = std::max(costFieldBudget, 0.0f);
+    if (costField) {
+        ImGui::Checkbox("Show cost field", &showCostField);
+        // Any cell of the field can be answered without a new search
+        if (ImGui::Button("Path to end from field")) {
+            ResetAnytime();
+            path = costField.PathTo(end.x, end.y);
+            path.nodesExpanded = costField.nodesExpanded;
+            pathBound = 1.0f;
+            UploadPath();
+        }
+    }
+
+    if (pathJob.Running() || fieldJob.Running()) {
+        const auto& job = pathJob.Running() ? pathJob.GetProgress() : fieldJob.GetProgress();
+        ImGui::Text("Searching: %zu nodes, frontier at %.2f (%.1f sec)",
+                    job.nodesExpanded.load(std::memory_order_relaxed),
+                    job.frontierCost.load(std::memory_order_relaxed),
+                    pathJob.Running() ? pathJob.ElapsedSec() : fieldJob.ElapsedSec());
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel")) {
+            pathJob.Cancel();
+            fieldJob.Cancel();
+        }
+    }
+
     if (path) {
-        ImGui::Text("Found path with cost %.2f (%.3f sec)", path.cost, jobTimeSec);
+        if (pathBound > 1.0f) {
+            ImGui::Text("Found path with cost %.2f, bound %.2fx (%.3f sec)", path.cost,
+                        pathBound, jobTimeSec);
+        } else {
+            ImGui::Text("Found path with cost %.2f (%.3f sec)", path.cost, jobTimeSec);
+        }
+        ImGui::Text("%zu nodes expanded", path.nodesExpanded);
     } else {
         ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 0, 0, 255));
         ImGui::Text("No path found (%.3f sec)", jobTimeSec);
@@ -1,13 +1,18 @@
 #pragma once
 
-#include <future>
+#include <tuple>
 
+#include "AnytimePlanner.h"
 #include "Core/Camera/Camera.h"
 #include "Core/Mesh.h"
 #include "Core/Program.h"
 #include "Core/Texture.h"
 #include "Core/Transform.h"
+#include "EdgeCostCache.h"
+#include "IncrementalPlanner.h"
+#include "Metric.h"
 #include "PathFinder.h"
+#include "SearchJob.h"
 #include "Terrain.h"
 
 class AppLogic {
@@ -20,14 +25,38 @@ public:
     void UI();
 
 private:
+    using Metrics = std::tuple<PathFinder::Weighted<Metric::DistanceCost>,
+                               PathFinder::Weighted<Metric::SlopeCost>,
+                               PathFinder::Weighted<Metric::TerrainCost>>;
+    // Start, end, distance, slope and terrain weights, connectivity
+    using LiveSettings =
+        std::tuple<glm::ivec2, glm::ivec2, float, float, float, PathFinder::Connectivity>;
+
     void UpdateFlagTransforms();
+    void UploadPath();
+    // The weights of the UI on the current terrain
+    Metrics CurrentMetrics() const;
+    // Baked costs for these metrics if enabled, else null. Null as well once `stop` is
+    // requested during the bake. Called by the jobs.
+    std::shared_ptr<const EdgeCostGrid> EdgeCosts(bool bake,
+                                                  const Metrics& metrics,
+                                                  const std::stop_token& stop);
+    // The path and cost field settings of the UI, copied for a job
+    PathFinder CurrentFinder() const;
+    // Repairs the last live route for the current settings, in the path job
+    void Replan();
+    // New anytime search for the current settings once the bake job has its edge costs,
+    // then improved by Update() on every frame
+    void StartAnytime();
+    // Drops the anytime search, and its bake if still running
+    void ResetAnytime();
 
 private:
     std::unique_ptr<Camera> camera;
 
     Mesh terrainMesh, waterMesh, pathMesh, flagMesh;
     Program terrainProgram, waterProgram, lineProgram, flagProgram;
-    Texture heightTex, normalTex, typeTex;
+    Texture heightTex, normalTex, typeTex, costFieldTex;
 
     // Flags
     glm::ivec2 start = {20, 20};
@@ -43,17 +72,48 @@ private:
     Terrain terrain;
 
     // Path find
-    std::future<PathFinder::Path> pendingJob;
-    bool jobRunning = false;
-    double jobTimeStartSec;
     double jobTimeSec = 0.0;
     PathFinder::Path path;
     bool allowBridges = false;
+    BridgeNetwork::Settings bridgeSettings;
+    BridgeNetwork::Settings builtBridgeSettings;
+    std::shared_ptr<const BridgeNetwork> bridges; // Built on demand, shared with the jobs
+    bool bakeEdgeCosts = false;
+    LiveSettings plannedSettings; // Of the last replan
+    EdgeCostCache edgeCostCache; // Only touched by the jobs
+    ThreadPool pool;
 
     float distanceWeight = 0.1f;
     float terrainWeight = 10.f;
     float slopeWeight = 1.0f;
 
+    // Cost field (one-to-all from the start flag)
+    PathFinder::CostField costField;
+    float costFieldBudget = 0.0f; // 0 for the whole map
+    float costFieldMax = 0.0f;    // Largest reached cost, top of the color scale
+    bool showCostField = false;
+
     PathFinder::Connectivity connectivity = PathFinder::Connectivity::C8;
     static constexpr const char* CONNECTIVITY_NAMES[] = {"C-4", "C-8"};
+
+    PathFinder::SearchMode searchMode = PathFinder::SearchMode::A_STAR;
+    bool bidirectional = false;
+    static constexpr const char* SEARCH_MODE_NAMES[] = {"Dijkstra", "A*"};
+
+    // Replans on every change of the flags or weights, bridges off
+    enum class LiveMode { OFF, INCREMENTAL, ANYTIME };
+    LiveMode liveMode = LiveMode::OFF;
+    static constexpr const char* LIVE_MODE_NAMES[] = {"Off", "D* Lite", "Anytime (ARA*)"};
+    float frameBudgetMs = 4.0f; // Of the anytime search, per frame
+    float pathBound = 1.0f;     // The path costs at most this times the optimal one
+
+    AnytimePlanner anytime; // Main thread only
+
+    // Only one of them runs at a time: starting one cancels the other. Last members, so that
+    // they are stopped before what their tasks use is destroyed.
+    SearchWorkspace workspace;  // Reused by the path jobs
+    IncrementalPlanner planner; // Only touched by the path jobs
+    SearchJob<PathFinder::Path> pathJob;
+    SearchJob<PathFinder::CostField> fieldJob;
+    SearchJob<std::shared_ptr<const EdgeCostGrid>> bakeJob; // Of the anytime search
 };
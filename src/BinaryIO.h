@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+// Raw native-endian reads and writes of trivially copyable values, for the cache files
+// of the preprocessed routers: a cache for this machine, not an exchange format.
+namespace BinaryIO {
+
+    template <typename T>
+    void Write(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Element count, then the elements
+    template <typename T>
+    void WriteVector(std::ofstream& out, const std::vector<T>& values) {
+        Write(out, static_cast<uint64_t>(values.size()));
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    T Read(std::ifstream& in) {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+    // fileSize bounds the element count before allocating, against truncated files
+    template <typename T>
+    std::vector<T> ReadVector(std::ifstream& in, const uint64_t fileSize) {
+        const auto count = Read<uint64_t>(in);
+        if (!in || count > fileSize / sizeof(T))
+            throw std::runtime_error("BinaryIO::ReadVector() - Truncated file");
+
+        std::vector<T> values(count);
+        in.read(reinterpret_cast<char*>(values.data()),
+                static_cast<std::streamsize>(count * sizeof(T)));
+        if (!in)
+            throw std::runtime_error("BinaryIO::ReadVector() - Truncated file");
+        return values;
+    }
+
+} // namespace BinaryIO
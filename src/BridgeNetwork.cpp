@@ -0,0 +1,126 @@
+#include "BridgeNetwork.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Terrain.h"
+
+BridgeNetwork BridgeNetwork::FromSegments(const glm::ivec2& size,
+                                          const std::span<const Segment> segments) {
+    BridgeNetwork ret;
+    ret.size = size;
+    ret.offsets.assign(static_cast<size_t>(size.x) * size.y + 1, 0);
+    ret.bridges.resize(segments.size());
+
+    const auto index = [&](const glm::ivec2& p) { return p.y * size.x + p.x; };
+
+    // Counting sort on the source cell
+    for (const auto& [from, to] : segments)
+        ret.offsets[index(from) + 1]++;
+
+    for (size_t i = 1; i < ret.offsets.size(); i++)
+        ret.offsets[i] += ret.offsets[i - 1];
+
+    std::vector<uint32_t> cursor(ret.offsets.begin(), ret.offsets.end() - 1);
+    for (const auto& [from, to] : segments) {
+        const float length = std::hypotf(to.x - from.x, to.y - from.y);
+        ret.bridges[cursor[index(from)]++] = {to.x, to.y, length};
+    }
+
+    return ret;
+}
+
+BridgeNetwork BridgeNetwork::Generate(const glm::ivec2& size, const Settings& settings) {
+    const auto segments = SampleSegments(size, settings, [](const Segment&) { return true; });
+    return FromSegments(size, segments);
+}
+
+BridgeNetwork BridgeNetwork::Generate(const Terrain& terrain, const Settings& settings) {
+    using TileType = Terrain::TileType;
+    const auto& types = terrain.typeMap;
+
+    const auto keep = [&](const Segment& s) {
+        if (!settings.crossWaterOnly)
+            return true;
+
+        // Both ends on land
+        if (types(s.from.x, s.from.y) == TileType::WATER ||
+            types(s.to.x, s.to.y) == TileType::WATER)
+            return false;
+
+        // Span crosses water
+        const glm::ivec2 delta = s.to - s.from;
+        const int steps = std::max(std::abs(delta.x), std::abs(delta.y));
+        for (int i = 1; i < steps; i++) {
+            const float t = static_cast<float>(i) / static_cast<float>(steps);
+            const int x = s.from.x + static_cast<int>(std::lround(delta.x * t));
+            const int y = s.from.y + static_cast<int>(std::lround(delta.y * t));
+            if (types(x, y) == TileType::WATER)
+                return true;
+        }
+        return false;
+    };
+
+    const auto segments = SampleSegments(terrain.dimensions, settings, keep);
+    return FromSegments(terrain.dimensions, segments);
+}
+
+template <typename Filter>
+std::vector<BridgeNetwork::Segment> BridgeNetwork::SampleSegments(const glm::ivec2& size,
+                                                                  const Settings& settings,
+                                                                  const Filter& keep) {
+    std::vector<Segment> segments;
+    if (size.x <= 0 || size.y <= 0)
+        return segments;
+
+    std::mt19937 rng(settings.seed);
+
+    const int minLength = std::max(1, std::min(settings.minLength, settings.maxLength));
+    const int maxLength = std::max(1, std::max(settings.minLength, settings.maxLength));
+    const float cells = static_cast<float>(size.x) * static_cast<float>(size.y);
+    const int numSamples =
+        std::max(settings.minSamples, static_cast<int>(cells * settings.sampleDensity));
+
+    // mt19937 is specified to the bit, the standard distributions and cos/sin are not: the
+    // draws are reduced by multiply-shift (bias of range / 2^32) and the directions come from
+    // a table, so that every platform builds the same network
+    const auto draw = [&](const int low, const int high) {
+        const uint64_t range = static_cast<uint64_t>(high - low) + 1;
+        return low + static_cast<int>((static_cast<uint64_t>(rng()) * range) >> 32);
+    };
+    constexpr float DIAGONAL = 0.70710677f;
+    constexpr float DIRECTIONS[8][2] = {
+        {1.0f, 0.0f},  {DIAGONAL, DIAGONAL},   {0.0f, 1.0f},  {-DIAGONAL, DIAGONAL},
+        {-1.0f, 0.0f}, {-DIAGONAL, -DIAGONAL}, {0.0f, -1.0f}, {DIAGONAL, -DIAGONAL}};
+
+    for (int i = 0; i < numSamples; i++) {
+        const int x1 = draw(0, size.x - 1);
+        const int y1 = draw(0, size.y - 1);
+        const int length = draw(minLength, maxLength);
+
+        for (const auto& direction : DIRECTIONS) {
+            const int x2 = x1 + static_cast<int>(static_cast<float>(length) * direction[0]);
+            const int y2 = y1 + static_cast<int>(static_cast<float>(length) * direction[1]);
+
+            if (x2 < 0 || x2 >= size.x || y2 < 0 || y2 >= size.y)
+                continue;
+
+            const Segment segment{{x1, y1}, {x2, y2}};
+            if (keep(segment)) {
+                segments.push_back(segment);
+                segments.push_back({segment.to, segment.from});
+            }
+        }
+    }
+
+    return segments;
+}
+
+std::span<const BridgeNetwork::Bridge> BridgeNetwork::From(const int x, const int y) const {
+    if (offsets.empty())
+        return {};
+
+    const size_t i = static_cast<size_t>(y) * size.x + x;
+    return {bridges.data() + offsets[i], bridges.data() + offsets[i + 1]};
+}
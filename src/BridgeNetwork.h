@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct Terrain;
+
+// Bridge candidates stored as a CSR adjacency: the bridges leaving cell i are
+// bridges[offsets[i] .. offsets[i + 1]), so a lookup costs O(out-degree).
+//
+// A network is immutable once built: build it once per terrain and share it
+// between queries (PathFinder::SetBridges).
+class BridgeNetwork {
+public:
+    struct Segment {
+        glm::ivec2 from;
+        glm::ivec2 to;
+    };
+
+    struct Bridge {
+        int x, y; // Destination cell
+        float length;
+    };
+
+    struct Settings {
+        uint32_t seed = 0;
+        int minLength = 50;
+        int maxLength = 200;
+        float sampleDensity = 0.01f; // Sampled origins per cell
+        int minSamples = 100;
+        bool crossWaterOnly = true; // Only used when generated from a Terrain
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    BridgeNetwork() = default;
+
+    static BridgeNetwork FromSegments(const glm::ivec2& size, std::span<const Segment> segments);
+
+    // Same settings and seed always produce the same network
+    static BridgeNetwork Generate(const glm::ivec2& size, const Settings& settings);
+
+    // Keeps only the candidates going from land to land over water (if crossWaterOnly)
+    static BridgeNetwork Generate(const Terrain& terrain, const Settings& settings);
+
+    std::span<const Bridge> From(int x, int y) const;
+
+    const glm::ivec2& GridSize() const { return size; }
+    size_t Count() const { return bridges.size(); }
+    bool Empty() const { return bridges.empty(); }
+
+private:
+    template <typename Filter>
+    static std::vector<Segment>
+    SampleSegments(const glm::ivec2& size, const Settings& settings, const Filter& keep);
+
+private:
+    glm::ivec2 size = {0, 0};
+    std::vector<uint32_t> offsets;
+    std::vector<Bridge> bridges;
+};
@@ -0,0 +1,541 @@
+#include "ClusterHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "Algorithm.h"
+#include "BinaryIO.h"
+
+namespace {
+
+    constexpr uint32_t FILE_MAGIC = 0x48434d48; // "HMCH"
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    // Dijkstra restricted to the cells in [min, max). The reverse search walks the edges
+    // backwards: its costs are the costs from each cell to the source.
+    class LocalSearch {
+    public:
+        void Run(const EdgeCostGrid& grid,
+                 const int directionCount,
+                 const glm::ivec2& areaMin,
+                 const glm::ivec2& areaMax,
+                 const glm::ivec2& source,
+                 const bool backwards) {
+            min = areaMin;
+            max = areaMax;
+            width = max.x - min.x;
+            reverse = backwards;
+            nodesExpanded = 0;
+
+            const size_t area = static_cast<size_t>(width) * (max.y - min.y);
+            costs.assign(area, INF);
+            directions.assign(area, -1);
+            heap.clear();
+
+            costs[Index(source)] = 0.0f;
+            heap.emplace_back(0.0f, static_cast<int>(Index(source)));
+
+            while (!heap.empty()) {
+                std::ranges::pop_heap(heap, std::greater{});
+                const auto [cost, i] = heap.back();
+                heap.pop_back();
+
+                if (cost > costs[i])
+                    continue;
+                nodesExpanded++;
+
+                const glm::ivec2 cell(min.x + i % width, min.y + i / width);
+                for (int dir = 0; dir < directionCount; dir++) {
+                    const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                    const glm::ivec2 next(cell.x + dx, cell.y + dy);
+                    if (next.x < min.x || next.y < min.y || next.x >= max.x || next.y >= max.y)
+                        continue;
+
+                    const int opposite = EdgeCostGrid::OPPOSITE[dir];
+                    const float edge =
+                        reverse ? grid(next.x, next.y, opposite) : grid(cell.x, cell.y, dir);
+                    if (std::isinf(edge))
+                        continue;
+
+                    const float newCost = cost + edge;
+                    const size_t j = Index(next);
+                    if (newCost < costs[j]) {
+                        costs[j] = newCost;
+                        directions[j] = static_cast<int8_t>(reverse ? opposite : dir);
+                        heap.emplace_back(newCost, static_cast<int>(j));
+                        std::ranges::push_heap(heap, std::greater{});
+                    }
+                }
+            }
+        }
+
+        float Cost(const glm::ivec2& cell) const { return costs[Index(cell)]; }
+
+        // Directions from the source to `cell`, or from `cell` to the source when reverse
+        void AppendSteps(glm::ivec2 cell, std::vector<uint8_t>& out) const {
+            const size_t first = out.size();
+            for (int dir = directions[Index(cell)]; dir != -1; dir = directions[Index(cell)]) {
+                out.push_back(static_cast<uint8_t>(dir));
+                const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                cell += reverse ? glm::ivec2(dx, dy) : glm::ivec2(-dx, -dy);
+            }
+            if (!reverse)
+                std::reverse(out.begin() + static_cast<ptrdiff_t>(first), out.end());
+        }
+
+        size_t nodesExpanded = 0;
+
+    private:
+        size_t Index(const glm::ivec2& cell) const {
+            return static_cast<size_t>(cell.y - min.y) * width + (cell.x - min.x);
+        }
+
+    private:
+        glm::ivec2 min = {0, 0};
+        glm::ivec2 max = {0, 0};
+        int width = 0;
+        bool reverse = false;
+        std::vector<float> costs;
+        std::vector<int8_t> directions; // Step into each cell (forward) or out of it (reverse)
+        std::vector<std::pair<float, int>> heap;
+    };
+
+} // namespace
+
+ClusterHierarchy ClusterHierarchy::Build(std::shared_ptr<const EdgeCostGrid> grid,
+                                         const Settings& settings,
+                                         ThreadPool& pool) {
+    if (!grid || grid->Size().x <= 0 || grid->Size().y <= 0)
+        throw std::runtime_error("ClusterHierarchy::Build() - Empty edge cost grid");
+    if (settings.clusterSize < 2 || settings.entranceSpacing < 1)
+        throw std::runtime_error("ClusterHierarchy::Build() - Invalid settings");
+
+    ClusterHierarchy ret;
+    ret.settings = settings;
+    ret.size = grid->Size();
+    ret.clusterCount = {(ret.size.x + settings.clusterSize - 1) / settings.clusterSize,
+                        (ret.size.y + settings.clusterSize - 1) / settings.clusterSize};
+    ret.key = Key(*grid, settings);
+    ret.grid = std::move(grid);
+
+    const EdgeCostGrid& costs = *ret.grid;
+    const int clusterTotal = ret.clusterCount.x * ret.clusterCount.y;
+
+    struct PendingLink {
+        int from;
+        Link link;
+    };
+    std::vector<PendingLink> pending;
+
+    // --- Entrances: one node on each side of the border, linked by a single step ---
+    std::unordered_map<int, int> nodeOf;
+    const auto addNode = [&](const glm::ivec2& cell) {
+        const auto [it, inserted] = nodeOf.try_emplace(cell.y * ret.size.x + cell.x,
+                                                       static_cast<int>(ret.nodes.size()));
+        if (inserted)
+            ret.nodes.push_back(cell);
+        return it->second;
+    };
+
+    // Border cells first + along * i, i in [0, length), each facing the next cluster in `dir`
+    const auto placeEntrances = [&](const glm::ivec2& first, const glm::ivec2& along,
+                                    const int length, const int dir) {
+        const int opposite = EdgeCostGrid::OPPOSITE[dir];
+        const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+        const glm::ivec2 across(dx, dy);
+
+        const auto isOpen = [&](const int i) {
+            const glm::ivec2 a = first + along * i;
+            const glm::ivec2 b = a + across;
+            return !std::isinf(costs(a.x, a.y, dir)) && !std::isinf(costs(b.x, b.y, opposite));
+        };
+        const auto link = [&](const int i) {
+            const glm::ivec2 a = first + along * i;
+            const glm::ivec2 b = a + across;
+            const int na = addNode(a);
+            const int nb = addNode(b);
+            const auto offset = static_cast<uint32_t>(ret.steps.size());
+            pending.push_back({na, {nb, costs(a.x, a.y, dir), offset, 1}});
+            pending.push_back({nb, {na, costs(b.x, b.y, opposite), offset + 1, 1}});
+            ret.steps.push_back(static_cast<uint8_t>(dir));
+            ret.steps.push_back(static_cast<uint8_t>(opposite));
+        };
+
+        // Openings are cut into chunks of at most entranceSpacing cells, each crossed at
+        // its cheapest edge pair: weighted costs make the middle cell a poor choice
+        for (int i = 0; i < length;) {
+            if (!isOpen(i)) {
+                i++;
+                continue;
+            }
+            int end = i + 1;
+            while (end < length && isOpen(end))
+                end++;
+
+            const int chunkCount = (end - i + settings.entranceSpacing - 1) /
+                settings.entranceSpacing;
+            for (int chunk = 0; chunk < chunkCount; chunk++) {
+                const int chunkBegin = i + (end - i) * chunk / chunkCount;
+                const int chunkEnd = i + (end - i) * (chunk + 1) / chunkCount;
+
+                int cheapest = chunkBegin;
+                float cheapestCost = INF;
+                for (int j = chunkBegin; j < chunkEnd; j++) {
+                    const glm::ivec2 a = first + along * j;
+                    const glm::ivec2 b = a + across;
+                    const float cost = costs(a.x, a.y, dir) + costs(b.x, b.y, opposite);
+                    if (cost < cheapestCost) {
+                        cheapest = j;
+                        cheapestCost = cost;
+                    }
+                }
+                link(cheapest);
+            }
+            i = end;
+        }
+    };
+
+    for (int cluster = 0; cluster < clusterTotal; cluster++) {
+        const glm::ivec2 min = ret.ClusterMin(cluster);
+        const glm::ivec2 max = ret.ClusterMax(cluster);
+
+        // Right and top neighbors: every shared border is scanned once
+        if (max.x < ret.size.x)
+            placeEntrances({max.x - 1, min.y}, {0, 1}, max.y - min.y, 2);
+        if (max.y < ret.size.y)
+            placeEntrances({min.x, max.y - 1}, {1, 0}, max.x - min.x, 0);
+    }
+
+    // Nodes of each cluster, counting sort on the cluster
+    ret.clusterOffsets.assign(clusterTotal + 1, 0);
+    for (const auto& node : ret.nodes)
+        ret.clusterOffsets[ret.ClusterOf(node) + 1]++;
+    for (size_t i = 1; i < ret.clusterOffsets.size(); i++)
+        ret.clusterOffsets[i] += ret.clusterOffsets[i - 1];
+
+    ret.clusterNodes.resize(ret.nodes.size());
+    std::vector<uint32_t> cursor(ret.clusterOffsets.begin(), ret.clusterOffsets.end() - 1);
+    for (size_t i = 0; i < ret.nodes.size(); i++)
+        ret.clusterNodes[cursor[ret.ClusterOf(ret.nodes[i])]++] = static_cast<int>(i);
+
+    // --- Cheapest path between each pair of entrances of a cluster, inside the cluster ---
+    struct ClusterLinks {
+        std::vector<PendingLink> links;
+        std::vector<uint8_t> steps;
+    };
+    std::vector<ClusterLinks> inner(clusterTotal);
+    std::vector<LocalSearch> searches(pool.ThreadCount());
+    const int directionCount = static_cast<int>(settings.connectivity);
+
+    pool.ParallelFor(clusterTotal, [&](const size_t c, const unsigned worker) {
+        const int cluster = static_cast<int>(c);
+        const auto members = std::span(ret.clusterNodes)
+                                 .subspan(ret.clusterOffsets[c],
+                                          ret.clusterOffsets[c + 1] - ret.clusterOffsets[c]);
+        LocalSearch& search = searches[worker];
+        ClusterLinks& out = inner[c];
+
+        for (const int from : members) {
+            search.Run(costs, directionCount, ret.ClusterMin(cluster), ret.ClusterMax(cluster),
+                       ret.nodes[from], false);
+
+            for (const int to : members) {
+                const float cost = search.Cost(ret.nodes[to]);
+                if (to == from || std::isinf(cost))
+                    continue;
+
+                const auto offset = static_cast<uint32_t>(out.steps.size());
+                search.AppendSteps(ret.nodes[to], out.steps);
+                const auto count = static_cast<uint32_t>(out.steps.size()) - offset;
+                out.links.push_back({from, {to, cost, offset, count}});
+            }
+        }
+    });
+
+    for (auto& [links, steps] : inner) {
+        const auto shift = static_cast<uint32_t>(ret.steps.size());
+        ret.steps.insert(ret.steps.end(), steps.begin(), steps.end());
+        for (auto& [from, link] : links) {
+            link.stepOffset += shift;
+            pending.push_back({from, link});
+        }
+    }
+
+    // Links as a CSR adjacency, counting sort on the source node
+    ret.linkOffsets.assign(ret.nodes.size() + 1, 0);
+    for (const auto& [from, link] : pending)
+        ret.linkOffsets[from + 1]++;
+    for (size_t i = 1; i < ret.linkOffsets.size(); i++)
+        ret.linkOffsets[i] += ret.linkOffsets[i - 1];
+
+    ret.links.resize(pending.size());
+    cursor.assign(ret.linkOffsets.begin(), ret.linkOffsets.end() - 1);
+    for (const auto& [from, link] : pending)
+        ret.links[cursor[from]++] = link;
+
+    return ret;
+}
+
+void ClusterHierarchy::Save(const std::filesystem::path& path) const {
+    if (!grid)
+        throw std::runtime_error("ClusterHierarchy::Save() - Empty hierarchy");
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("ClusterHierarchy::Save() - Failed to open " + path.string());
+
+    BinaryIO::Write(out, FILE_MAGIC);
+    BinaryIO::Write(out, FILE_VERSION);
+    BinaryIO::Write(out, key);
+    BinaryIO::Write(out, settings.clusterSize);
+    BinaryIO::Write(out, static_cast<int32_t>(settings.connectivity));
+    BinaryIO::Write(out, settings.entranceSpacing);
+    BinaryIO::WriteVector(out, nodes);
+    BinaryIO::WriteVector(out, linkOffsets);
+    BinaryIO::WriteVector(out, links);
+    BinaryIO::WriteVector(out, steps);
+    BinaryIO::WriteVector(out, clusterOffsets);
+    BinaryIO::WriteVector(out, clusterNodes);
+
+    if (!out)
+        throw std::runtime_error("ClusterHierarchy::Save() - Failed to write " + path.string());
+}
+
+ClusterHierarchy ClusterHierarchy::Load(const std::filesystem::path& path,
+                                        std::shared_ptr<const EdgeCostGrid> grid) {
+    if (!grid || grid->Size().x <= 0 || grid->Size().y <= 0)
+        throw std::runtime_error("ClusterHierarchy::Load() - Empty edge cost grid");
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("ClusterHierarchy::Load() - Failed to open " + path.string());
+    const uint64_t fileSize = std::filesystem::file_size(path);
+
+    if (BinaryIO::Read<uint32_t>(in) != FILE_MAGIC ||
+        BinaryIO::Read<uint32_t>(in) != FILE_VERSION)
+        throw std::runtime_error("ClusterHierarchy::Load() - Not a cluster hierarchy file");
+
+    ClusterHierarchy ret;
+    const auto storedKey = BinaryIO::Read<uint64_t>(in);
+    ret.settings.clusterSize = BinaryIO::Read<int32_t>(in);
+    ret.settings.connectivity =
+        static_cast<PathFinder::Connectivity>(BinaryIO::Read<int32_t>(in));
+    ret.settings.entranceSpacing = BinaryIO::Read<int32_t>(in);
+    if (!in || ret.settings.clusterSize < 2 ||
+        (ret.settings.connectivity != PathFinder::Connectivity::C4 &&
+         ret.settings.connectivity != PathFinder::Connectivity::C8))
+        throw std::runtime_error("ClusterHierarchy::Load() - Invalid settings");
+
+    ret.key = Key(*grid, ret.settings);
+    if (ret.key != storedKey)
+        throw std::runtime_error("ClusterHierarchy::Load() - Built from other edge costs");
+
+    ret.size = grid->Size();
+    ret.clusterCount = {(ret.size.x + ret.settings.clusterSize - 1) / ret.settings.clusterSize,
+                        (ret.size.y + ret.settings.clusterSize - 1) / ret.settings.clusterSize};
+    ret.grid = std::move(grid);
+
+    ret.nodes = BinaryIO::ReadVector<glm::ivec2>(in, fileSize);
+    ret.linkOffsets = BinaryIO::ReadVector<uint32_t>(in, fileSize);
+    ret.links = BinaryIO::ReadVector<Link>(in, fileSize);
+    ret.steps = BinaryIO::ReadVector<uint8_t>(in, fileSize);
+    ret.clusterOffsets = BinaryIO::ReadVector<uint32_t>(in, fileSize);
+    ret.clusterNodes = BinaryIO::ReadVector<int>(in, fileSize);
+
+    // The key matched: only guard against a corrupted file, not a different build
+    const size_t clusterTotal = static_cast<size_t>(ret.clusterCount.x) * ret.clusterCount.y;
+    const bool consistent = ret.linkOffsets.size() == ret.nodes.size() + 1 &&
+        ret.linkOffsets.back() == ret.links.size() &&
+        ret.clusterOffsets.size() == clusterTotal + 1 &&
+        ret.clusterOffsets.back() == ret.clusterNodes.size() &&
+        std::ranges::all_of(ret.links, [&](const Link& link) {
+            return link.to >= 0 && static_cast<size_t>(link.to) < ret.nodes.size() &&
+                static_cast<uint64_t>(link.stepOffset) + link.stepCount <= ret.steps.size();
+        });
+    if (!consistent)
+        throw std::runtime_error("ClusterHierarchy::Load() - Corrupted file");
+
+    return ret;
+}
+
+ClusterHierarchy ClusterHierarchy::LoadOrBuild(const std::filesystem::path& path,
+                                               std::shared_ptr<const EdgeCostGrid> grid,
+                                               const Settings& settings,
+                                               ThreadPool& pool) {
+    if (std::filesystem::exists(path)) {
+        // A stale or unreadable file is simply rebuilt
+        try {
+            auto loaded = Load(path, grid);
+            if (loaded.settings == settings)
+                return loaded;
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    auto built = Build(std::move(grid), settings, pool);
+    built.Save(path);
+    return built;
+}
+
+PathFinder::Path ClusterHierarchy::Compute(const glm::ivec2& start,
+                                           const glm::ivec2& end,
+                                           const float heuristicScale) const {
+    const auto inBounds = [this](const glm::ivec2& p) {
+        return p.x >= 0 && p.y >= 0 && p.x < size.x && p.y < size.y;
+    };
+    if (!grid || !inBounds(start) || !inBounds(end) || !(heuristicScale >= 0.0f))
+        return {};
+
+    const int directionCount = static_cast<int>(settings.connectivity);
+    const int startCluster = ClusterOf(start);
+    const int endCluster = ClusterOf(end);
+
+    // Cell by cell inside the start and end clusters only
+    LocalSearch fromStart, toEnd;
+    fromStart.Run(*grid, directionCount, ClusterMin(startCluster), ClusterMax(startCluster),
+                  start, false);
+    toEnd.Run(*grid, directionCount, ClusterMin(endCluster), ClusterMax(endCluster), end, true);
+    size_t nodesExpanded = fromStart.nodesExpanded + toEnd.nodesExpanded;
+
+    // Close ends: exact search over both clusters, which the entrances alone would miss
+    const glm::ivec2 startMin = ClusterMin(startCluster);
+    const glm::ivec2 endMin = ClusterMin(endCluster);
+    LocalSearch around;
+    const LocalSearch* direct = nullptr;
+    if (startCluster == endCluster) {
+        direct = &fromStart;
+    } else if (std::abs(startMin.x - endMin.x) <= settings.clusterSize &&
+               std::abs(startMin.y - endMin.y) <= settings.clusterSize) {
+        around.Run(*grid, directionCount, glm::min(startMin, endMin),
+                   glm::max(ClusterMax(startCluster), ClusterMax(endCluster)), start, false);
+        nodesExpanded += around.nodesExpanded;
+        direct = &around;
+    }
+
+    // Best route so far: the direct one, else leaving the start cluster through bestNode
+    float best = direct ? direct->Cost(end) : INF;
+    int bestNode = -1;
+
+    std::vector<float> costs(nodes.size(), INF);
+    std::vector<int> parentNodes(nodes.size(), -1);
+    std::vector<int> parentLinks(nodes.size(), -1); // -1: reached from the start cell
+    std::vector<std::pair<float, int>> heap;
+
+    for (uint32_t i = clusterOffsets[startCluster]; i < clusterOffsets[startCluster + 1]; i++) {
+        const int node = clusterNodes[i];
+        const float cost = fromStart.Cost(nodes[node]);
+        if (!std::isinf(cost)) {
+            costs[node] = cost;
+            heap.emplace_back(cost + Heuristic(nodes[node], end, heuristicScale), node);
+        }
+    }
+    std::ranges::make_heap(heap, std::greater{});
+
+    while (!heap.empty()) {
+        std::ranges::pop_heap(heap, std::greater{});
+        const auto [key, node] = heap.back();
+        heap.pop_back();
+
+        // The heuristic is consistent: no remaining route is cheaper than the key
+        if (key >= best)
+            break;
+
+        const float cost = costs[node];
+        if (key > cost + Heuristic(nodes[node], end, heuristicScale))
+            continue;
+        nodesExpanded++;
+
+        if (ClusterOf(nodes[node]) == endCluster && cost + toEnd.Cost(nodes[node]) < best) {
+            best = cost + toEnd.Cost(nodes[node]);
+            bestNode = node;
+        }
+
+        for (uint32_t l = linkOffsets[node]; l < linkOffsets[node + 1]; l++) {
+            const Link& link = links[l];
+            const float newCost = cost + link.cost;
+            if (newCost < costs[link.to]) {
+                costs[link.to] = newCost;
+                parentNodes[link.to] = node;
+                parentLinks[link.to] = static_cast<int>(l);
+                heap.emplace_back(newCost + Heuristic(nodes[link.to], end, heuristicScale),
+                                  link.to);
+                std::ranges::push_heap(heap, std::greater{});
+            }
+        }
+    }
+
+    PathFinder::Path path;
+    path.nodesExpanded = nodesExpanded;
+    if (std::isinf(best))
+        return path;
+
+    // Refinement: the stored steps of the links, between the two local searches
+    std::vector<uint8_t> route;
+    if (bestNode == -1) {
+        direct->AppendSteps(end, route);
+    } else {
+        std::vector<int> chain;
+        int first = bestNode;
+        for (; parentLinks[first] != -1; first = parentNodes[first])
+            chain.push_back(parentLinks[first]);
+
+        fromStart.AppendSteps(nodes[first], route);
+        for (const int l : chain | std::views::reverse) {
+            const auto begin = steps.begin() + links[l].stepOffset;
+            route.insert(route.end(), begin, begin + links[l].stepCount);
+        }
+        toEnd.AppendSteps(nodes[bestNode], route);
+    }
+
+    path.cost = best;
+    glm::ivec2 cell = start;
+    path.points.reserve(route.size() + 1);
+    path.points.emplace_back(cell);
+    for (const uint8_t dir : route) {
+        cell += glm::ivec2(EdgeCostGrid::DIRECTIONS[dir].dx, EdgeCostGrid::DIRECTIONS[dir].dy);
+        path.points.emplace_back(cell);
+    }
+    return path;
+}
+
+uint64_t ClusterHierarchy::Key(const EdgeCostGrid& grid, const Settings& settings) {
+    const auto connectivity = static_cast<int32_t>(settings.connectivity);
+
+    uint64_t key = Algorithm::Hash(&grid.Size(), sizeof(grid.Size()));
+    key = Algorithm::Hash(grid.Data(), grid.Count() * sizeof(float), key);
+    key = Algorithm::Hash(&settings.clusterSize, sizeof(settings.clusterSize), key);
+    key = Algorithm::Hash(&connectivity, sizeof(connectivity), key);
+    return Algorithm::Hash(&settings.entranceSpacing, sizeof(settings.entranceSpacing), key);
+}
+
+int ClusterHierarchy::ClusterOf(const glm::ivec2& cell) const {
+    return (cell.y / settings.clusterSize) * clusterCount.x + cell.x / settings.clusterSize;
+}
+
+glm::ivec2 ClusterHierarchy::ClusterMin(const int cluster) const {
+    return glm::ivec2(cluster % clusterCount.x, cluster / clusterCount.x) * settings.clusterSize;
+}
+
+glm::ivec2 ClusterHierarchy::ClusterMax(const int cluster) const {
+    return glm::min(ClusterMin(cluster) + settings.clusterSize, size);
+}
+
+float ClusterHierarchy::Heuristic(const glm::ivec2& cell,
+                                  const glm::ivec2& end,
+                                  const float scale) const {
+    const float dx = static_cast<float>(std::abs(cell.x - end.x));
+    const float dy = static_cast<float>(std::abs(cell.y - end.y));
+
+    // Same lower bounds as PathFinder: the links are grid paths
+    if (settings.connectivity == PathFinder::Connectivity::C4)
+        return scale * (dx + dy);
+    return scale * (std::max(dx, dy) + (1.41421356f - 1.0f) * std::min(dx, dy));
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EdgeCostGrid.h"
+#include "PathFinder.h"
+#include "ThreadPool.h"
+
+// Hierarchical path-finding (HPA*) over a baked EdgeCostGrid. The grid is cut into square
+// clusters, entrances are placed on the borders shared by two clusters and every pair of
+// entrances of a cluster is linked by its cheapest path inside the cluster. A query only
+// searches the start and end clusters cell by cell, then the graph of entrances.
+//
+// The routes go through the entrances, so they are near-optimal rather than optimal.
+// Bridges are not part of the graph. Like BridgeNetwork, a hierarchy is immutable once
+// built and can be shared between threads.
+class ClusterHierarchy {
+public:
+    struct Settings {
+        int clusterSize = 32;
+        PathFinder::Connectivity connectivity = PathFinder::Connectivity::C8;
+        // Longest stretch of an open border served by a single entrance
+        int entranceSpacing = 8;
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    ClusterHierarchy() = default;
+
+    // Entrances are placed serially, the paths inside the clusters are spread over the pool
+    static ClusterHierarchy Build(std::shared_ptr<const EdgeCostGrid> grid,
+                                  const Settings& settings,
+                                  ThreadPool& pool);
+
+    // Binary file, only valid with the grid costs it was built from (checked by Load())
+    void Save(const std::filesystem::path& path) const;
+    static ClusterHierarchy Load(const std::filesystem::path& path,
+                                 std::shared_ptr<const EdgeCostGrid> grid);
+
+    // Loads `path` if it was built from the same grid costs and settings, else builds the
+    // hierarchy and saves it there
+    static ClusterHierarchy LoadOrBuild(const std::filesystem::path& path,
+                                        std::shared_ptr<const EdgeCostGrid> grid,
+                                        const Settings& settings,
+                                        ThreadPool& pool);
+
+    // heuristicScale as in PathFinder::SetHeuristicScale(), 0 searches the entrances with
+    // Dijkstra. nodesExpanded counts the cells and the entrances expanded.
+    PathFinder::Path Compute(const glm::ivec2& start,
+                             const glm::ivec2& end,
+                             float heuristicScale = 0.0f) const;
+
+    const glm::ivec2& GridSize() const { return size; }
+    const Settings& GetSettings() const { return settings; }
+    size_t NodeCount() const { return nodes.size(); }
+    size_t LinkCount() const { return links.size(); }
+    bool Empty() const { return !grid; }
+
+private:
+    struct Link {
+        int to;
+        float cost;
+        uint32_t stepOffset; // Directions from this node to `to`, in steps
+        uint32_t stepCount;
+    };
+
+    // Hash of the grid costs and the settings, stored in the saved files
+    static uint64_t Key(const EdgeCostGrid& grid, const Settings& settings);
+
+    int ClusterOf(const glm::ivec2& cell) const;
+    glm::ivec2 ClusterMin(int cluster) const;
+    glm::ivec2 ClusterMax(int cluster) const; // Exclusive
+
+    float Heuristic(const glm::ivec2& cell, const glm::ivec2& end, float scale) const;
+
+private:
+    std::shared_ptr<const EdgeCostGrid> grid;
+    Settings settings;
+    uint64_t key = 0; // Key() of the grid and settings
+    glm::ivec2 size = {0, 0};
+    glm::ivec2 clusterCount = {0, 0};
+
+    std::vector<glm::ivec2> nodes;     // Entrance cells
+    std::vector<uint32_t> linkOffsets; // CSR: links of node i are links[linkOffsets[i]..[i + 1])
+    std::vector<Link> links;
+    std::vector<uint8_t> steps;
+    std::vector<uint32_t> clusterOffsets; // CSR: nodes of each cluster
+    std::vector<int> clusterNodes;
+};
@@ -0,0 +1,546 @@
+#include "ContractionHierarchy.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#include "BinaryIO.h"
+
+namespace {
+
+    constexpr uint32_t FILE_MAGIC = 0x48434843; // "CHCH"
+    constexpr uint32_t FILE_VERSION = 2;
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    // An arc is pruned when a path through higher ranked cells is cheaper by more than this,
+    // relatively: equal cost paths summed in another order only differ by rounding
+    constexpr float PRUNE_TOLERANCE = 1e-5f;
+
+    // Regions this small are not split further
+    constexpr int DISSECTION_LEAF = 4;
+
+    // Nested dissection of the grid: a row or column cuts a region in two halves that no
+    // edge joins (in C4 and C8 alike). The halves are ranked first, then the separator, itself
+    // dissected: a search climbing a separator then takes log steps, not one per cell.
+    // Cells without any edge (water) add no arc wherever they are ranked: within the middle
+    // half of a region, the cut takes the line with the fewest cells that have one.
+    // Returns the cells by rank.
+    std::vector<int> DissectionOrder(const glm::ivec2& size, const std::vector<bool>& open) {
+        // Of the line at `mid` across the region, either a column or a row
+        const auto openCount = [&](const bool column, const int mid, const int from,
+                                   const int to) {
+            int count = 0;
+            for (int i = from; i < to; i++)
+                count += open[column ? i * size.x + mid : mid * size.x + i];
+            return count;
+        };
+        const auto bestCut = [&](const bool column, const int begin, const int end,
+                                 const int from, const int to) {
+            const int middle = (begin + end) / 2;
+            const int reach = (end - begin) / 4;
+            int best = middle;
+            int bestCount = openCount(column, middle, from, to);
+            for (int offset = 1; offset <= reach && bestCount > 0; offset++) {
+                for (const int mid : {middle - offset, middle + offset}) {
+                    if (mid <= begin || mid >= end - 1)
+                        continue;
+                    if (const int count = openCount(column, mid, from, to); count < bestCount) {
+                        best = mid;
+                        bestCount = count;
+                    }
+                }
+            }
+            return best;
+        };
+
+        std::vector<int> order;
+        order.reserve(static_cast<size_t>(size.x) * size.y);
+
+        // Regions still to order. Each split pushes the separator below the halves: it only
+        // comes out once both are ordered.
+        std::vector<std::array<int, 4>> pending = {{0, 0, size.x, size.y}};
+
+        while (!pending.empty()) {
+            const auto [x0, y0, x1, y1] = pending.back();
+            pending.pop_back();
+
+            if ((x1 - x0) * (y1 - y0) <= DISSECTION_LEAF) {
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++)
+                        order.push_back(y * size.x + x);
+                }
+                continue;
+            }
+
+            if (x1 - x0 >= y1 - y0) {
+                const int mid = bestCut(true, x0, x1, y0, y1);
+                pending.push_back({mid, y0, mid + 1, y1});
+                pending.push_back({mid + 1, y0, x1, y1});
+                pending.push_back({x0, y0, mid, y1});
+            } else {
+                const int mid = bestCut(false, y0, y1, x0, x1);
+                pending.push_back({x0, mid, x1, mid + 1});
+                pending.push_back({x0, mid + 1, x1, y1});
+                pending.push_back({x0, y0, x1, mid});
+            }
+        }
+        return order;
+    }
+
+    // Contracted graph in rank space: for each rank, its higher ranked neighbors (sorted) and
+    // both arc directions with each. `up` is lower -> higher, `down` higher -> lower.
+    struct ContractedGraph {
+        // One direction of every arc
+        struct Side {
+            std::vector<float> costs;
+            std::vector<int> middles; // Rank the shortcut goes through, -1 for a grid edge
+            std::vector<bool> pruned;
+            std::vector<bool> witness; // On the detour of a pruned arc: never pruned
+
+            void Resize(const size_t count) {
+                costs.assign(count, INF);
+                middles.assign(count, -1);
+                pruned.assign(count, false);
+                witness.assign(count, false);
+            }
+        };
+
+        std::vector<uint32_t> offsets;
+        std::vector<int> heads;
+        Side up;
+        Side down;
+
+        std::span<const int> Neighbors(const int rank) const {
+            return {heads.data() + offsets[rank], heads.data() + offsets[rank + 1]};
+        }
+
+        // Index of the arc between rank `low` and the higher ranked `high`, which must exist
+        size_t Find(const int low, const int high) const {
+            const auto neighbors = Neighbors(low);
+            return offsets[low] + (std::ranges::lower_bound(neighbors, high) - neighbors.begin());
+        }
+    };
+
+    // Symbolic contraction: each rank in turn links its higher neighbors into a clique. Only
+    // the lowest of them needs the others: the rest follow when that one is contracted.
+    ContractedGraph Contract(const EdgeCostGrid& grid,
+                             const int directionCount,
+                             const std::vector<int>& ranks) {
+        const glm::ivec2& size = grid.Size();
+        const size_t cellCount = ranks.size();
+
+        std::vector<std::vector<int>> neighbors(cellCount);
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                for (int dir = 0; dir < directionCount; dir++) {
+                    if (std::isinf(grid(x, y, dir)))
+                        continue;
+
+                    const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                    const int from = ranks[y * size.x + x];
+                    const int to = ranks[(y + dy) * size.x + x + dx];
+                    neighbors[std::min(from, to)].push_back(std::max(from, to));
+                }
+            }
+        }
+
+        ContractedGraph graph;
+        graph.offsets.assign(cellCount + 1, 0);
+        for (size_t rank = 0; rank < cellCount; rank++) {
+            auto& list = neighbors[rank];
+            std::ranges::sort(list);
+            list.erase(std::ranges::unique(list).begin(), list.end());
+
+            if (list.size() > 1) {
+                auto& parent = neighbors[list.front()];
+                parent.insert(parent.end(), list.begin() + 1, list.end());
+            }
+
+            graph.offsets[rank + 1] = graph.offsets[rank] + static_cast<uint32_t>(list.size());
+            graph.heads.insert(graph.heads.end(), list.begin(), list.end());
+            list = {};
+        }
+
+        graph.up.Resize(graph.heads.size());
+        graph.down.Resize(graph.heads.size());
+        return graph;
+    }
+
+    // Calls triangle(lowMiddle, lowHigh, middleHigh), the indices of the three arcs, for each
+    // triangle low < middle < high of the graph
+    template <typename Triangle>
+    void ForEachTriangle(const ContractedGraph& graph, const int low, const Triangle& triangle) {
+        const auto neighbors = graph.Neighbors(low);
+        for (size_t i = 0; i < neighbors.size(); i++) {
+            // The higher neighbors of `low` past neighbors[i] are all neighbors of neighbors[i]:
+            // one merge walk finds their arcs
+            const int middle = neighbors[i];
+            uint32_t arc = graph.offsets[middle];
+            for (size_t j = i + 1; j < neighbors.size(); j++) {
+                while (graph.heads[arc] != neighbors[j])
+                    arc++;
+                triangle(graph.offsets[low] + i, graph.offsets[low] + j, arc);
+            }
+        }
+    }
+
+    // Lowest ranks first, each arc takes the cheapest path through a lower ranked cell
+    void Customize(ContractedGraph& graph) {
+        auto& [upCosts, upMiddles, upPruned, upWitness] = graph.up;
+        auto& [downCosts, downMiddles, downPruned, downWitness] = graph.down;
+
+        const int rankCount = static_cast<int>(graph.offsets.size()) - 1;
+        for (int low = 0; low < rankCount; low++) {
+            ForEachTriangle(graph, low, [&](const size_t lm, const size_t lh, const size_t mh) {
+                if (downCosts[lm] + upCosts[lh] < upCosts[mh]) {
+                    upCosts[mh] = downCosts[lm] + upCosts[lh];
+                    upMiddles[mh] = low;
+                }
+                if (downCosts[lh] + upCosts[lm] < downCosts[mh]) {
+                    downCosts[mh] = downCosts[lh] + upCosts[lm];
+                    downMiddles[mh] = low;
+                }
+            });
+        }
+    }
+
+    // Highest ranks first, each arc is checked against the paths through the higher ranked
+    // cells. The arcs such a path beats are not needed by any query and are pruned: most of
+    // the shortcuts between separator cells go.
+    //
+    // Only a strictly cheaper detour prunes. On a tie (zero cost edges make them common), two
+    // arcs could each be pruned for the other and both be lost. For the same reason, the arcs
+    // of a detour are kept once it has pruned an arc.
+    void Prune(ContractedGraph& graph) {
+        using Side = ContractedGraph::Side;
+
+        // `arc` against the detour first + second
+        const auto relax = [](Side& side, const size_t arc, Side& firstSide, const size_t first,
+                              Side& secondSide, const size_t second) {
+            const float via = firstSide.costs[first] + secondSide.costs[second];
+            if (side.witness[arc] || !(via * (1.0f + PRUNE_TOLERANCE) < side.costs[arc]))
+                return;
+
+            side.costs[arc] = via;
+            side.pruned[arc] = true;
+            firstSide.witness[first] = true;
+            secondSide.witness[second] = true;
+        };
+
+        auto& up = graph.up;
+        auto& down = graph.down;
+        const int rankCount = static_cast<int>(graph.offsets.size()) - 1;
+        for (int low = rankCount - 1; low >= 0; low--) {
+            ForEachTriangle(graph, low, [&](const size_t lm, const size_t lh, const size_t mh) {
+                relax(up, lh, up, lm, up, mh);
+                relax(down, lh, down, mh, down, lm);
+                relax(up, lm, up, lh, down, mh);
+                relax(down, lm, up, mh, down, lh);
+            });
+        }
+
+        // The shortcuts kept still unpack through their two halves: keep those too, from
+        // the highest ranks down since the halves are ranked below the shortcut
+        for (int low = rankCount - 1; low >= 0; low--) {
+            const auto neighbors = graph.Neighbors(low);
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                const size_t arc = graph.offsets[low] + i;
+                const int high = neighbors[i];
+
+                if (const int middle = up.middles[arc]; !up.pruned[arc] && middle != -1) {
+                    down.pruned[graph.Find(middle, low)] = false;
+                    up.pruned[graph.Find(middle, high)] = false;
+                }
+                if (const int middle = down.middles[arc]; !down.pruned[arc] && middle != -1) {
+                    down.pruned[graph.Find(middle, high)] = false;
+                    up.pruned[graph.Find(middle, low)] = false;
+                }
+            }
+        }
+    }
+
+} // namespace
+
+ContractionHierarchy ContractionHierarchy::Build(const EdgeCostGrid& grid,
+                                                 const PathFinder::Connectivity connectivity,
+                                                 const uint64_t profile) {
+    if (grid.Size().x <= 0 || grid.Size().y <= 0)
+        throw std::runtime_error("ContractionHierarchy::Build() - Empty edge cost grid");
+
+    ContractionHierarchy ret;
+    ret.size = grid.Size();
+    ret.connectivity = connectivity;
+    ret.profile = profile;
+
+    const size_t cellCount = static_cast<size_t>(ret.size.x) * ret.size.y;
+    std::vector<bool> open(cellCount, false);
+    for (int y = 0; y < ret.size.y; y++) {
+        for (int x = 0; x < ret.size.x; x++) {
+            for (int dir = 0; dir < static_cast<int>(connectivity); dir++) {
+                if (std::isinf(grid(x, y, dir)))
+                    continue;
+
+                // Both ends: the grid may hold one direction of an edge only
+                const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                open[y * ret.size.x + x] = true;
+                open[(y + dy) * ret.size.x + x + dx] = true;
+            }
+        }
+    }
+    const std::vector<int> order = DissectionOrder(ret.size, open);
+    std::vector<int> ranks(cellCount);
+    for (size_t rank = 0; rank < cellCount; rank++)
+        ranks[order[rank]] = static_cast<int>(rank);
+
+    const int directionCount = static_cast<int>(connectivity);
+    ContractedGraph graph = Contract(grid, directionCount, ranks);
+
+    // The grid edges, then the shortcuts through the lower ranks
+    for (int y = 0; y < ret.size.y; y++) {
+        for (int x = 0; x < ret.size.x; x++) {
+            for (int dir = 0; dir < directionCount; dir++) {
+                const float cost = grid(x, y, dir);
+                if (std::isinf(cost))
+                    continue;
+
+                const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+                const int from = ranks[y * ret.size.x + x];
+                const int to = ranks[(y + dy) * ret.size.x + x + dx];
+                if (from < to)
+                    graph.up.costs[graph.Find(from, to)] = cost;
+                else
+                    graph.down.costs[graph.Find(to, from)] = cost;
+            }
+        }
+    }
+    Customize(graph);
+    Prune(graph);
+
+    // Back to cells, in CSR: up arcs stored at their source, down arcs at their target. Each
+    // side is released once flattened.
+    const auto flatten = [&](ContractedGraph::Side& side,
+                             std::vector<uint32_t>& offsets, std::vector<Arc>& arcs) {
+        offsets.assign(cellCount + 1, 0);
+        for (size_t cell = 0; cell < cellCount; cell++) {
+            const int low = ranks[cell];
+            for (uint32_t i = graph.offsets[low]; i < graph.offsets[low + 1]; i++) {
+                if (side.pruned[i] || std::isinf(side.costs[i]))
+                    continue;
+
+                const int middle = side.middles[i];
+                arcs.push_back({order[graph.heads[i]], side.costs[i],
+                                middle == -1 ? -1 : order[middle]});
+                ret.shortcutCount += middle != -1 ? 1 : 0;
+            }
+            offsets[cell + 1] = static_cast<uint32_t>(arcs.size());
+        }
+        side = {};
+    };
+    flatten(graph.up, ret.upOffsets, ret.up);
+    flatten(graph.down, ret.downOffsets, ret.down);
+
+    return ret;
+}
+
+void ContractionHierarchy::Save(const std::filesystem::path& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("ContractionHierarchy::Save() - Failed to open " +
+                                 path.string());
+
+    BinaryIO::Write(out, FILE_MAGIC);
+    BinaryIO::Write(out, FILE_VERSION);
+    BinaryIO::Write(out, profile);
+    BinaryIO::Write(out, size);
+    BinaryIO::Write(out, static_cast<int32_t>(connectivity));
+    BinaryIO::Write(out, static_cast<uint64_t>(shortcutCount));
+    BinaryIO::WriteVector(out, upOffsets);
+    BinaryIO::WriteVector(out, up);
+    BinaryIO::WriteVector(out, downOffsets);
+    BinaryIO::WriteVector(out, down);
+
+    if (!out)
+        throw std::runtime_error("ContractionHierarchy::Save() - Failed to write " +
+                                 path.string());
+}
+
+ContractionHierarchy ContractionHierarchy::Load(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("ContractionHierarchy::Load() - Failed to open " +
+                                 path.string());
+    const uint64_t fileSize = std::filesystem::file_size(path);
+
+    if (BinaryIO::Read<uint32_t>(in) != FILE_MAGIC ||
+        BinaryIO::Read<uint32_t>(in) != FILE_VERSION)
+        throw std::runtime_error("ContractionHierarchy::Load() - Not a contraction hierarchy");
+
+    ContractionHierarchy ret;
+    ret.profile = BinaryIO::Read<uint64_t>(in);
+    ret.size = BinaryIO::Read<glm::ivec2>(in);
+    ret.connectivity = static_cast<PathFinder::Connectivity>(BinaryIO::Read<int32_t>(in));
+    ret.shortcutCount = BinaryIO::Read<uint64_t>(in);
+    if (!in || ret.size.x <= 0 || ret.size.y <= 0 ||
+        (ret.connectivity != PathFinder::Connectivity::C4 &&
+         ret.connectivity != PathFinder::Connectivity::C8))
+        throw std::runtime_error("ContractionHierarchy::Load() - Invalid header");
+
+    ret.upOffsets = BinaryIO::ReadVector<uint32_t>(in, fileSize);
+    ret.up = BinaryIO::ReadVector<Arc>(in, fileSize);
+    ret.downOffsets = BinaryIO::ReadVector<uint32_t>(in, fileSize);
+    ret.down = BinaryIO::ReadVector<Arc>(in, fileSize);
+
+    // Guards the queries against a corrupted file
+    const size_t cellCount = static_cast<size_t>(ret.size.x) * ret.size.y;
+    const auto validArcs = [&](const std::vector<uint32_t>& offsets, const std::vector<Arc>& arcs) {
+        return offsets.size() == cellCount + 1 && offsets.back() == arcs.size() &&
+            std::ranges::is_sorted(offsets) &&
+            std::ranges::all_of(arcs, [&](const Arc& arc) {
+                return arc.node >= 0 && static_cast<size_t>(arc.node) < cellCount &&
+                    arc.middle >= -1 && arc.middle < static_cast<int>(cellCount);
+            });
+    };
+    if (!validArcs(ret.upOffsets, ret.up) || !validArcs(ret.downOffsets, ret.down))
+        throw std::runtime_error("ContractionHierarchy::Load() - Corrupted file");
+
+    return ret;
+}
+
+PathFinder::Path ContractionHierarchy::Compute(const glm::ivec2& start,
+                                               const glm::ivec2& end,
+                                               SearchWorkspace& workspace) const {
+    const auto inBounds = [this](const glm::ivec2& p) {
+        return p.x >= 0 && p.y >= 0 && p.x < size.x && p.y < size.y;
+    };
+    if (Empty() || !inBounds(start) || !inBounds(end))
+        return {};
+
+    using Frontier = SearchWorkspace::Frontier;
+    using Queue = PriorityQueue::BinaryHeap;
+
+    Frontier& forward = workspace.forward;
+    Frontier& backward = workspace.backward;
+    forward.Reset(size, {});
+    backward.Reset(size, {});
+    Queue& forwardQueue = forward.GetQueue<Queue>();
+    Queue& backwardQueue = backward.GetQueue<Queue>();
+    forwardQueue.Reset(forward.CellCount());
+    backwardQueue.Reset(backward.CellCount());
+
+    const int source = start.y * size.x + start.x;
+    const int target = end.y * size.x + end.x;
+    forward.Set(source, 0.0f, -1);
+    backward.Set(target, 0.0f, -1);
+    forwardQueue.Push({static_cast<uint32_t>(source), 0.0f});
+    backwardQueue.Push({static_cast<uint32_t>(target), 0.0f});
+
+    float best = source == target ? 0.0f : INF;
+    int meet = source;
+    size_t nodesExpanded = 0;
+
+    while (true) {
+        // Each search climbs until its queue holds nothing cheaper than the best path
+        const float topForward = forwardQueue.Empty() ? INF : forwardQueue.Top().cost;
+        const float topBackward = backwardQueue.Empty() ? INF : backwardQueue.Top().cost;
+        if (std::min(topForward, topBackward) >= best)
+            break;
+
+        const bool isForward = topForward <= topBackward;
+        Frontier& self = isForward ? forward : backward;
+        const Frontier& other = isForward ? backward : forward;
+        Queue& pq = isForward ? forwardQueue : backwardQueue;
+        const auto& offsets = isForward ? upOffsets : downOffsets;
+        const auto& arcs = isForward ? up : down;
+        const auto& reverseOffsets = isForward ? downOffsets : upOffsets;
+        const auto& reverseArcs = isForward ? down : up;
+
+        const auto [cell, cost] = pq.Top();
+        pq.Pop();
+
+        const int node = static_cast<int>(cell);
+        if (cost > self.Cost(node))
+            continue;
+        nodesExpanded++;
+
+        if (cost + other.Cost(node) < best) {
+            best = cost + other.Cost(node);
+            meet = node;
+        }
+
+        // Stall on demand: a higher ranked cell reaching this one cheaper means this cost is
+        // not the distance, so nothing relaxed from here can be on the cheapest path
+        bool stalled = false;
+        for (uint32_t i = reverseOffsets[node]; i < reverseOffsets[node + 1] && !stalled; i++)
+            stalled = self.Cost(reverseArcs[i].node) + reverseArcs[i].cost < cost;
+        if (stalled)
+            continue;
+
+        for (uint32_t i = offsets[node]; i < offsets[node + 1]; i++) {
+            const Arc& arc = arcs[i];
+            const float newCost = cost + arc.cost;
+            if (newCost < self.Cost(arc.node)) {
+                self.Set(arc.node, newCost, node);
+                pq.Push({static_cast<uint32_t>(arc.node), newCost});
+            }
+        }
+    }
+
+    PathFinder::Path path;
+    path.nodesExpanded = nodesExpanded;
+    if (std::isinf(best))
+        return path;
+
+    // Up the forward search to the meeting cell, then down the backward one
+    std::vector<int> chain;
+    for (int node = meet; node != -1; node = forward.Parent(node))
+        chain.push_back(node);
+    std::ranges::reverse(chain);
+
+    path.cost = best;
+    path.points.emplace_back(start);
+    for (size_t i = 1; i < chain.size(); i++)
+        Unpack(chain[i - 1], chain[i], FindUp(chain[i - 1], chain[i]).middle, path.points);
+    for (int node = meet, next = backward.Parent(meet); next != -1;
+         node = next, next = backward.Parent(next))
+        Unpack(node, next, FindDown(node, next).middle, path.points);
+
+    return path;
+}
+
+const ContractionHierarchy::Arc& ContractionHierarchy::FindUp(const int from, const int to) const {
+    const auto first = up.begin() + upOffsets[from];
+    return *std::find_if(first, up.begin() + upOffsets[from + 1],
+                         [to](const Arc& arc) { return arc.node == to; });
+}
+
+const ContractionHierarchy::Arc& ContractionHierarchy::FindDown(const int from,
+                                                                const int to) const {
+    const auto first = down.begin() + downOffsets[to];
+    return *std::find_if(first, down.begin() + downOffsets[to + 1],
+                         [from](const Arc& arc) { return arc.node == from; });
+}
+
+void ContractionHierarchy::Unpack(const int from,
+                                  const int to,
+                                  const int middle,
+                                  std::vector<glm::vec2>& points) const {
+    // Arcs still to expand, the next one on top: cells come out in path order
+    std::vector<std::array<int, 3>> pending = {{from, to, middle}};
+
+    while (!pending.empty()) {
+        const auto [a, b, m] = pending.back();
+        pending.pop_back();
+
+        if (m == -1) {
+            points.emplace_back(glm::ivec2(b % size.x, b / size.x));
+            continue;
+        }
+
+        // The middle is ranked below both ends: a -> m is stored at m as a down arc
+        pending.push_back({m, b, FindUp(m, b).middle});
+        pending.push_back({a, m, FindDown(a, m).middle});
+    }
+}
@@ -29,7 +29,7 @@ public:
     GLuint Handle() const { return handle; }
 
     template <typename T>
-    static Texture From(const Mat<T>& mat) {
+    static Texture From(const MatView<T>& mat) {
         Format format;
 
         // clang-format off
@@ -42,6 +42,11 @@ public:
         return {mat.Width(), mat.Height(), format, mat.Data()};
     }
 
+    template <typename T>
+    static Texture From(const Mat<T>& mat) {
+        return From(MatView<T>(mat));
+    }
+
 private:
     void Cleanup();
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <utility>
+
+#include "EdgeCostGrid.h"
+#include "PathFinder.h"
+
+// Keeps the last baked EdgeCostGrid and rebuilds it only when the grid size, a weight or
+// a metric (Hash(), which covers the terrain maps) changes. Hashing the maps is linear but
+// far cheaper than baking: call Get() once per batch or per UI action, not per query.
+class EdgeCostCache {
+public:
+    template <typename... Costs>
+    std::shared_ptr<const EdgeCostGrid> Get(const glm::ivec2& size,
+                                            ThreadPool& pool,
+                                            const PathFinder::Weighted<Costs>&... costs) {
+        return Get(size, pool, std::stop_token{}, costs...);
+    }
+
+    // Same, null if a stop is requested while baking: the previous grid is kept
+    template <typename... Costs>
+    std::shared_ptr<const EdgeCostGrid> Get(const glm::ivec2& size,
+                                            ThreadPool& pool,
+                                            const std::stop_token& stop,
+                                            const PathFinder::Weighted<Costs>&... costs) {
+        const uint64_t key = PathFinder::ProfileHash(size, costs...);
+
+        if (!grid || key != builtKey) {
+            auto baked = PathFinder::BakeEdgeCosts(size, pool, stop, costs...);
+            if (!baked)
+                return nullptr;
+
+            grid = std::make_shared<EdgeCostGrid>(std::move(*baked));
+            builtKey = key;
+        }
+        return grid;
+    }
+
+    void Clear() { grid.reset(); }
+
+private:
+    std::shared_ptr<const EdgeCostGrid> grid;
+    uint64_t builtKey = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Weighted cost of every grid edge, baked for a fixed terrain and fixed metric weights
+// (see PathFinder::BakeEdgeCosts()): the cost of leaving cell (x, y) in C8 direction
+// `dir` is a single load. Edges leaving the grid are infinite.
+//
+// The load is not always cheaper than the metrics: the fused Metric kernels read two map
+// cells each, and the grid is 32 bytes per cell against 5 for the maps. With them, queries
+// run about as fast baked as not (0.85-1.05x in the edge-costs bench). Baking pays off for
+// the type-erased metrics of PathFinder::With() (1.15-1.35x), for custom metrics costlier
+// than a few loads, and as the input of ClusterHierarchy and ContractionHierarchy.
+//
+// The 8 costs of a cell are stored together: expanding a cell reads all of them, which
+// then come from one cache line instead of one line per direction plane.
+class EdgeCostGrid {
+public:
+    static constexpr int DIRECTION_COUNT = 8;
+
+    struct Direction {
+        int dx, dy;
+        float d;
+    };
+
+    // The C4 directions are the first four
+    // clang-format off
+    static constexpr Direction DIRECTIONS[] = {
+        {00, 01, 1.0f}, {00, -1, 1.0f}, {01, 00, 1.0f}, {-1, 00, 1.0f},
+        {01, 01, 1.41421356f}, {01, -1, 1.41421356f},
+        {-1, 01, 1.41421356f}, {-1, -1, 1.41421356f},
+    };
+    static constexpr int OPPOSITE[] = {1, 0, 3, 2, 7, 6, 5, 4};
+    // clang-format on
+
+    EdgeCostGrid() = default;
+    explicit EdgeCostGrid(const glm::ivec2& size) :
+        size(size), costs(static_cast<size_t>(size.x) * size.y * DIRECTION_COUNT,
+                          std::numeric_limits<float>::infinity()) {}
+
+    const glm::ivec2& Size() const { return size; }
+
+    float operator()(const int x, const int y, const int dir) const {
+        return costs[Index(x, y) + dir];
+    }
+
+    // Raw costs, DIRECTION_COUNT per cell in row-major order
+    const float* Data() const { return costs.data(); }
+    size_t Count() const { return costs.size(); }
+
+    // The DIRECTION_COUNT costs leaving (x, y)
+    float* Cell(const int x, const int y) { return &costs[Index(x, y)]; }
+    const float* Cell(const int x, const int y) const { return &costs[Index(x, y)]; }
+
+private:
+    size_t Index(const int x, const int y) const {
+        return (static_cast<size_t>(y) * size.x + x) * DIRECTION_COUNT;
+    }
+
+private:
+    glm::ivec2 size{0, 0};
+    std::vector<float> costs;
+};
@@ -1,5 +1,185 @@
 #include "HeightMap.h"
 
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stb/stb_image.h>
+
+#include "Algorithm.h"
+
+namespace {
+
+    struct GridHeader {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t bits = 32;
+        enum class PixelType { FLOAT, SIGNED_INT, UNSIGNED_INT } pixelType = PixelType::FLOAT;
+        bool bigEndian = false;
+        std::optional<double> noData;
+    };
+
+    std::string Lower(std::string s) {
+        std::ranges::transform(s, s.begin(), [](const unsigned char c) { return std::tolower(c); });
+        return s;
+    }
+
+    // "key value" lines, case-insensitive. Unknown keys (georeferencing, ...) are ignored.
+    GridHeader ReadGridHeader(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("HeightMap::Decode() - Missing grid header " + path.string());
+
+        GridHeader header;
+        bool pixelTypeSet = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ss(line);
+            std::string key, value;
+            if (!(ss >> key >> value))
+                continue;
+            key = Lower(key);
+            value = Lower(value);
+
+            if (key == "ncols") {
+                header.width = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "nrows") {
+                header.height = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "nbits") {
+                header.bits = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "pixeltype") {
+                pixelTypeSet = true;
+                if (value == "float")
+                    header.pixelType = GridHeader::PixelType::FLOAT;
+                else if (value == "signedint")
+                    header.pixelType = GridHeader::PixelType::SIGNED_INT;
+                else if (value == "unsignedint")
+                    header.pixelType = GridHeader::PixelType::UNSIGNED_INT;
+                else
+                    throw std::runtime_error("HeightMap::Decode() - Unknown pixel type: " + value);
+            } else if (key == "byteorder") {
+                header.bigEndian = value == "msbfirst" || value == "m";
+            } else if (key == "nodata_value" || key == "nodata") {
+                header.noData = std::stod(value);
+            }
+        }
+
+        // 16-bit grids are integers unless stated otherwise
+        if (!pixelTypeSet && header.bits == 16)
+            header.pixelType = GridHeader::PixelType::UNSIGNED_INT;
+
+        const bool valid = header.width > 0 && header.height > 0 &&
+            (header.bits == 32 || (header.bits == 16 &&
+                                   header.pixelType != GridHeader::PixelType::FLOAT));
+        if (!valid)
+            throw std::runtime_error("HeightMap::Decode() - Invalid grid header " + path.string());
+        return header;
+    }
+
+    template <typename T>
+    T ReadSample(const char* p, const bool swap) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        if (swap) {
+            if constexpr (sizeof(T) == 2)
+                value = std::bit_cast<T>(std::byteswap(std::bit_cast<uint16_t>(value)));
+            else
+                value = std::bit_cast<T>(std::byteswap(std::bit_cast<uint32_t>(value)));
+        }
+        return value;
+    }
+
+    HeightMap::Decoded DecodeGrid(const std::filesystem::path& path) {
+        auto headerPath = path;
+        const GridHeader header = ReadGridHeader(headerPath.replace_extension(".hdr"));
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("HeightMap::Decode() - Failed to open " + path.string());
+
+        const size_t sampleSize = header.bits / 8;
+        const size_t rowBytes = header.width * sampleSize;
+        if (std::filesystem::file_size(path) < rowBytes * header.height)
+            throw std::runtime_error("HeightMap::Decode() - Truncated grid " + path.string());
+
+        const bool swap = header.bigEndian != (std::endian::native == std::endian::big);
+
+        HeightMap::Decoded ret;
+        ret.size = {header.width, header.height};
+        ret.grid = Mat<float>(ret.size);
+        float low = std::numeric_limits<float>::max();
+        float high = std::numeric_limits<float>::lowest();
+
+        // One row buffer: the file is never held whole in memory
+        std::vector<char> row(rowBytes);
+        for (uint32_t r = 0; r < header.height; r++) {
+            in.read(row.data(), static_cast<std::streamsize>(rowBytes));
+            if (!in)
+                throw std::runtime_error("HeightMap::Decode() - Failed to read " + path.string());
+
+            // The file goes north to south
+            float* values = &ret.grid(0, header.height - 1 - r);
+            for (uint32_t x = 0; x < header.width; x++) {
+                const char* p = row.data() + x * sampleSize;
+
+                float value;
+                if (header.bits == 16)
+                    value = header.pixelType == GridHeader::PixelType::SIGNED_INT
+                        ? ReadSample<int16_t>(p, swap)
+                        : ReadSample<uint16_t>(p, swap);
+                else if (header.pixelType == GridHeader::PixelType::FLOAT)
+                    value = ReadSample<float>(p, swap);
+                else if (header.pixelType == GridHeader::PixelType::SIGNED_INT)
+                    value = static_cast<float>(ReadSample<int32_t>(p, swap));
+                else
+                    value = static_cast<float>(ReadSample<uint32_t>(p, swap));
+
+                const bool valid = std::isfinite(value) &&
+                    !(header.noData && static_cast<double>(value) == *header.noData);
+                values[x] = valid ? value : std::numeric_limits<float>::quiet_NaN();
+                if (valid) {
+                    low = std::min(low, value);
+                    high = std::max(high, value);
+                }
+            }
+        }
+
+        ret.low = low <= high ? low : 0.0f;
+        ret.high = low < high ? high : ret.low + 1.0f;
+        return ret;
+    }
+
+    HeightMap::Decoded DecodeImage(const std::filesystem::path& path) {
+        stbi_set_flip_vertically_on_load(true);
+
+        const std::string file = path.string();
+        const bool wide = stbi_is_16_bit(file.c_str());
+
+        int w, h, bpp;
+        void* buf = wide ? static_cast<void*>(stbi_load_16(file.c_str(), &w, &h, &bpp, 1))
+                         : static_cast<void*>(stbi_load(file.c_str(), &w, &h, &bpp, 1));
+        if (!buf)
+            throw std::runtime_error("HeightMap::Decode() - Failed to load height image");
+
+        HeightMap::Decoded ret;
+        ret.size = {static_cast<uint32_t>(w), static_cast<uint32_t>(h)};
+        ret.pixels = std::shared_ptr<const void>(buf, stbi_image_free);
+        ret.wide = wide;
+        return ret;
+    }
+
+} // namespace
+
 Mat<float> HeightMap::Procedural(const glm::uvec2& size,
                                  const glm::vec2& min,
                                  const glm::vec2& max,
@@ -15,3 +195,48 @@ Mat<float> HeightMap::Procedural(const glm::uvec2& size,
     }
     return hm;
 }
+
+HeightMap::Decoded HeightMap::Decode(const std::filesystem::path& path) {
+    const std::string extension = Lower(path.extension().string());
+    if (extension == ".flt" || extension == ".bil" || extension == ".raw")
+        return DecodeGrid(path);
+    return DecodeImage(path);
+}
+
+Mat<float> HeightMap::Convert(Decoded decoded,
+                              ThreadPool* pool,
+                              const std::function<void(uint32_t, const float*)>& rowFn) {
+    const uint32_t width = decoded.size.x;
+
+    // Grids are converted in place
+    Mat<float> ret = decoded.pixels ? Mat<float>(decoded.size) : std::move(decoded.grid);
+
+    Algorithm::ForEachRow(static_cast<int>(decoded.size.y), pool, [&](const int y) {
+        float* heights = &ret(0, y);
+        const size_t first = static_cast<size_t>(y) * width;
+
+        if (decoded.pixels && decoded.wide) {
+            const auto* samples = static_cast<const stbi_us*>(decoded.pixels.get()) + first;
+            for (uint32_t x = 0; x < width; x++)
+                heights[x] = samples[x] / 65535.f;
+        } else if (decoded.pixels) {
+            const auto* samples = static_cast<const stbi_uc*>(decoded.pixels.get()) + first;
+            for (uint32_t x = 0; x < width; x++)
+                heights[x] = samples[x] / 255.f;
+        } else {
+            // To [0, 1] like the images, so that the height scale means the same for both
+            const float range = decoded.high - decoded.low;
+            for (uint32_t x = 0; x < width; x++)
+                heights[x] = std::isnan(heights[x]) ? 0.0f : (heights[x] - decoded.low) / range;
+        }
+
+        if (rowFn)
+            rowFn(static_cast<uint32_t>(y), heights);
+    });
+
+    return ret;
+}
+
+Mat<float> HeightMap::Load(const std::filesystem::path& path) {
+    return Convert(Decode(path));
+}
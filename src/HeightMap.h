@@ -1,12 +1,43 @@
 #pragma once
 
+#include <filesystem>
 #include <functional>
+#include <memory>
 
 #include "Mat.h"
+#include "ThreadPool.h"
 
 namespace HeightMap {
     Mat<float> Procedural(const glm::uvec2& size,
                           const glm::vec2& min,
                           const glm::vec2& max,
                           const std::function<float(const glm::vec2&)>& f);
+
+    // Decodes straight into the Mat, at the full precision of the file:
+    //  - PNG and the other stb formats: 8-bit (/ 255) or 16-bit (/ 65535) grayscale.
+    //  - .flt / .bil / .raw: raw grid with an ESRI-style .hdr sidecar (ncols, nrows,
+    //    nbits 16|32, pixeltype float|signedint|unsignedint, byteorder LSBFIRST|MSBFIRST,
+    //    nodata_value). Read a row at a time, rescaled to [0, 1] over the range of the grid,
+    //    nodata cells at 0.
+    // Row 0 is the bottom (south) row in every case.
+    Mat<float> Load(const std::filesystem::path& path);
+
+    // A height file read to its native samples, before the conversion to [0, 1].
+    // Load() is Decode() then Convert(), split for callers that fuse their own work per row.
+    struct Decoded {
+        glm::uvec2 size{0, 0};
+        std::shared_ptr<const void> pixels; // Images: 8 or 16-bit stb pixels
+        bool wide = false;
+        Mat<float> grid;                    // Grids: raw values, NaN for nodata
+        float low = 0.0f;                   // Grids: range of the valid values
+        float high = 1.0f;
+    };
+
+    Decoded Decode(const std::filesystem::path& path);
+
+    // Rows in blocks over the pool, if any. rowFn(y, heights), if set, runs on each row right
+    // after its conversion, on the same worker: post-processing fused into the same pass.
+    Mat<float> Convert(Decoded decoded,
+                       ThreadPool* pool = nullptr,
+                       const std::function<void(uint32_t, const float*)>& rowFn = {});
 }
@@ -0,0 +1,308 @@
+#include "IncrementalPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+    constexpr float INF = std::numeric_limits<float>::infinity();
+    constexpr auto& STEPS = EdgeCostGrid::DIRECTIONS;
+
+    // Relative to the tip's key, see ComputeShortestPath(). Float sums along a path drift by
+    // a few ulps per cell: this covers paths of thousands of cells.
+    constexpr float KEY_MARGIN = 1e-4f;
+
+    // Min-heap on the keys
+    constexpr auto LATER = [](const auto& a, const auto& b) { return b.key < a.key; };
+
+} // namespace
+
+void IncrementalPlanner::SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> grid) {
+    const glm::ivec2 gridSize = grid ? grid->Size() : glm::ivec2(0);
+    SetEdgeCosts(std::move(grid), glm::ivec2(0), gridSize - 1);
+}
+
+void IncrementalPlanner::SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> newGrid,
+                                      const glm::ivec2& regionMin,
+                                      const glm::ivec2& regionMax) {
+    if (newGrid == grid)
+        return;
+
+    const auto previous = std::exchange(grid, std::move(newGrid));
+    if (!initialized || !previous || !grid || grid->Size() != size) {
+        size = grid ? grid->Size() : glm::ivec2(0);
+        initialized = false;
+        return;
+    }
+
+    // An edge only enters rhs of its first cell, or of its second one when rooted at the start
+    const glm::ivec2 low = glm::max(regionMin, glm::ivec2(0));
+    const glm::ivec2 high = glm::min(regionMax, size - 1);
+    std::vector<int> changed;
+
+    for (int y = low.y; y <= high.y; y++) {
+        for (int x = low.x; x <= high.x; x++) {
+            for (int dir = 0; dir < static_cast<int>(connectivity); dir++) {
+                if ((*previous)(x, y, dir) == (*grid)(x, y, dir))
+                    continue;
+
+                const glm::ivec2 cell = rootedAtStart ? Neighbor({x, y}, dir) : glm::ivec2(x, y);
+                if (InBounds(cell))
+                    changed.push_back(Index(cell));
+            }
+        }
+    }
+
+    // Past this, most of the search is reopened anyway
+    if (changed.size() > static_cast<size_t>(size.x) * size.y / 8) {
+        initialized = false;
+        return;
+    }
+
+    for (const int i : changed)
+        Repair(i);
+}
+
+void IncrementalPlanner::SetConnectivity(const PathFinder::Connectivity c) {
+    if (c != connectivity)
+        initialized = false;
+    connectivity = c;
+}
+
+void IncrementalPlanner::SetHeuristicScale(const float scale) {
+    if (scale != heuristicScale)
+        initialized = false;
+    heuristicScale = scale;
+}
+
+void IncrementalPlanner::SetStart(const glm::ivec2& cell) {
+    if (cell != start && rootedAtStart)
+        Reroot(false);
+    start = cell;
+}
+
+void IncrementalPlanner::SetGoal(const glm::ivec2& cell) {
+    if (cell != goal && !rootedAtStart)
+        Reroot(true);
+    goal = cell;
+}
+
+void IncrementalPlanner::Reset() {
+    initialized = false;
+}
+
+void IncrementalPlanner::Reroot(const bool atStart) {
+    // Moving the root changes the cost of every cell: a repair would reopen all of them,
+    // twice. A new search from the end that stays is cheaper, and its tip then moves for free.
+    rootedAtStart = atStart;
+    initialized = false;
+}
+
+PathFinder::Path IncrementalPlanner::Plan(const std::stop_token& stop) {
+    if (!grid || !InBounds(start) || !InBounds(goal))
+        return {};
+    if (!initialized)
+        Initialize();
+
+    // The queue keys were computed for the tip of the last update
+    km += Heuristic(last, Tip());
+    last = Tip();
+
+    PathFinder::Path path;
+    if (!ComputeShortestPath(stop, path.nodesExpanded)) {
+        path.stopped = true;
+        return path;
+    }
+
+    // The tip may be left overconsistent: rhs is its cost
+    const int tip = Index(Tip());
+    if (std::isinf(rhs[tip]))
+        return path;
+
+    // Down the cost gradient to the root: the cheapest neighbor of each cell
+    const size_t maxLength = static_cast<size_t>(size.x) * size.y;
+    glm::ivec2 cell = Tip();
+    path.points.emplace_back(cell);
+
+    while (cell != Root() && path.points.size() <= maxLength) {
+        float best = INF;
+        glm::ivec2 next = cell;
+        for (int dir = 0; dir < static_cast<int>(connectivity); dir++) {
+            const glm::ivec2 n = Neighbor(cell, dir);
+            if (!InBounds(n))
+                continue;
+
+            const float cost = Cost(cell, dir) + g[Index(n)];
+            if (cost < best) {
+                best = cost;
+                next = n;
+            }
+        }
+
+        if (std::isinf(best))
+            return {};
+        cell = next;
+        path.points.emplace_back(cell);
+    }
+
+    if (cell != Root())
+        return {};
+    if (rootedAtStart)
+        std::ranges::reverse(path.points);
+    path.cost = rhs[tip];
+    return path;
+}
+
+bool IncrementalPlanner::InBounds(const glm::ivec2& cell) const {
+    return cell.x >= 0 && cell.x < size.x && cell.y >= 0 && cell.y < size.y;
+}
+
+float IncrementalPlanner::Heuristic(const glm::ivec2& a, const glm::ivec2& b) const {
+    const float dx = static_cast<float>(std::abs(a.x - b.x));
+    const float dy = static_cast<float>(std::abs(a.y - b.y));
+
+    if (connectivity == PathFinder::Connectivity::C4)
+        return heuristicScale * (dx + dy); // Manhattan
+    return heuristicScale * (std::max(dx, dy) + (1.41421356f - 1.0f) * std::min(dx, dy));
+}
+
+glm::ivec2 IncrementalPlanner::Neighbor(const glm::ivec2& cell, const int dir) {
+    return cell + glm::ivec2(STEPS[dir].dx, STEPS[dir].dy);
+}
+
+float IncrementalPlanner::Cost(const glm::ivec2& cell, const int dir) const {
+    if (!rootedAtStart)
+        return (*grid)(cell.x, cell.y, dir);
+
+    const glm::ivec2 n = Neighbor(cell, dir);
+    return (*grid)(n.x, n.y, EdgeCostGrid::OPPOSITE[dir]);
+}
+
+IncrementalPlanner::Key IncrementalPlanner::CalculateKey(const int i) const {
+    const float m = std::min(g[i], rhs[i]);
+    return {m + Heuristic(Tip(), Cell(i)) + km, m};
+}
+
+float IncrementalPlanner::MinNeighbor(const int i) const {
+    const glm::ivec2 cell = Cell(i);
+    float best = INF;
+
+    for (int dir = 0; dir < static_cast<int>(connectivity); dir++) {
+        const glm::ivec2 n = Neighbor(cell, dir);
+        if (InBounds(n))
+            best = std::min(best, Cost(cell, dir) + g[Index(n)]);
+    }
+    return best;
+}
+
+void IncrementalPlanner::UpdateVertex(const int i) {
+    if (g[i] == rhs[i]) {
+        queued[i] = 0;
+        return;
+    }
+
+    const Key key = CalculateKey(i);
+    if (!queued[i] || key != keys[i]) {
+        keys[i] = key;
+        queued[i] = 1;
+        heap.push_back({key, i});
+        std::ranges::push_heap(heap, LATER);
+    }
+}
+
+void IncrementalPlanner::Repair(const int i) {
+    if (i != Index(Root()))
+        rhs[i] = MinNeighbor(i);
+    UpdateVertex(i);
+}
+
+IncrementalPlanner::Key IncrementalPlanner::TopKey() {
+    while (!heap.empty()) {
+        const auto& [key, cell] = heap.front();
+        if (queued[cell] && keys[cell] == key)
+            return key;
+
+        std::ranges::pop_heap(heap, LATER);
+        heap.pop_back();
+    }
+    return {INF, INF};
+}
+
+bool IncrementalPlanner::ComputeShortestPath(const std::stop_token& stop, size_t& nodesExpanded) {
+    const int tip = Index(Tip());
+    const int root = Index(Root());
+    const int directionCount = static_cast<int>(connectivity);
+
+    while (true) {
+        // Every cell of the cheapest path has a key below the tip's with a consistent
+        // heuristic. Where it is exact (flat ground) they tie, and the float sums can then
+        // put one just above: the margin keeps those expanded. The tip itself is settled,
+        // so that the path can be walked down g.
+        const Key top = TopKey();
+        const Key tipKey = CalculateKey(tip);
+        const Key bound = {tipKey.k1 + KEY_MARGIN * tipKey.k1, tipKey.k2};
+        if (heap.empty() || (!(top < bound) && rhs[tip] == g[tip]))
+            return true;
+
+        const int u = heap.front().cell;
+        std::ranges::pop_heap(heap, LATER);
+        heap.pop_back();
+        queued[u] = 0;
+
+        const glm::ivec2 cell = Cell(u);
+        const Key key = CalculateKey(u);
+
+        if (top < key) {
+            // Queued before km grew: requeued with its current key
+            UpdateVertex(u);
+        } else if (g[u] > rhs[u]) {
+            // Overconsistent: settled, its neighbors may now go through it
+            g[u] = rhs[u];
+            for (int dir = 0; dir < directionCount; dir++) {
+                const glm::ivec2 p = Neighbor(cell, EdgeCostGrid::OPPOSITE[dir]);
+                if (!InBounds(p) || Index(p) == root)
+                    continue;
+
+                const int pi = Index(p);
+                rhs[pi] = std::min(rhs[pi], Cost(p, dir) + g[u]);
+                UpdateVertex(pi);
+            }
+        } else {
+            // Underconsistent: its cost went up, so may those of the cells that went through it
+            const float previous = g[u];
+            g[u] = INF;
+            Repair(u);
+            for (int dir = 0; dir < directionCount; dir++) {
+                const glm::ivec2 p = Neighbor(cell, EdgeCostGrid::OPPOSITE[dir]);
+                if (!InBounds(p))
+                    continue;
+
+                const float cost = Cost(p, dir);
+                if (!std::isinf(cost) && rhs[Index(p)] == cost + previous)
+                    Repair(Index(p));
+            }
+        }
+
+        nodesExpanded++;
+        if (nodesExpanded % PathFinder::PROGRESS_INTERVAL == 0 && stop.stop_requested())
+            return false;
+    }
+}
+
+void IncrementalPlanner::Initialize() {
+    const size_t cellCount = static_cast<size_t>(size.x) * size.y;
+    g.assign(cellCount, INF);
+    rhs.assign(cellCount, INF);
+    keys.assign(cellCount, {INF, INF});
+    queued.assign(cellCount, 0);
+    heap.clear();
+
+    km = 0.0f;
+    last = Tip();
+    initialized = true;
+
+    rhs[Index(Root())] = 0.0f;
+    UpdateVertex(Index(Root()));
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EdgeCostGrid.h"
+#include "PathFinder.h"
+
+// D* Lite over the C4/C8 grid of an EdgeCostGrid, for a route that keeps changing a little:
+// a dragged flag, an edited patch of terrain. The search is rooted at one end and aims for the
+// other one (the tip); its costs are kept between Plan() calls. Moving the tip only shifts the
+// queue keys, and changed edge costs only reopen the cells whose cheapest path went through
+// them: the repair stops as soon as the tip is settled again.
+//
+// A new weight changes every edge: SetEdgeCosts() then starts a new search, which is slower
+// than a plain A* (the "first" rows of the incremental bench).
+//
+// Moving the root would change every cost, so the root is the end that stays: the first move
+// of an end starts a search rooted at the other one, the next moves of the same end are repairs.
+// Bridges are not part of the graph. The heuristic must be a lower bound of the edge costs,
+// as with PathFinder::SetHeuristicScale().
+class IncrementalPlanner {
+public:
+    IncrementalPlanner() = default;
+
+    // The first grid, or one of another size, starts a new search. Afterwards only the cells
+    // whose edges changed are repaired; when they are many (e.g. every cost changed with
+    // a weight) a new search is cheaper and is started instead.
+    void SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> grid);
+    // Same, when only the edges leaving the cells of [regionMin, regionMax] may have changed,
+    // e.g. a rectangle of the type map edited and grown by one cell: nothing else is compared
+    void SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> grid,
+                      const glm::ivec2& regionMin,
+                      const glm::ivec2& regionMax);
+    // A change starts a new search
+    void SetConnectivity(PathFinder::Connectivity c);
+    void SetHeuristicScale(float scale);
+
+    // Either one moving makes it the tip, see above
+    void SetStart(const glm::ivec2& cell);
+    void SetGoal(const glm::ivec2& cell);
+
+    // Cheapest path from the start to the goal, nodesExpanded counting this call only.
+    // Gives up (Path::stopped) once `stop` is requested, checked every
+    // PathFinder::PROGRESS_INTERVAL expansions: the next call resumes the repair.
+    PathFinder::Path Plan(const std::stop_token& stop = {});
+
+    // Drops the search state: the next Plan() starts over
+    void Reset();
+
+private:
+    // D* Lite queue key, compared lexicographically
+    struct Key {
+        float k1, k2;
+
+        bool operator<(const Key& other) const {
+            return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2);
+        }
+        bool operator==(const Key& other) const = default;
+    };
+
+    // Lazy deletion: an entry is live while its cell is queued with that same key
+    struct Entry {
+        Key key;
+        int cell;
+    };
+
+    const glm::ivec2& Root() const { return rootedAtStart ? start : goal; }
+    const glm::ivec2& Tip() const { return rootedAtStart ? goal : start; }
+    // Starts a search rooted at the start or at the goal on the next Plan()
+    void Reroot(bool atStart);
+
+    bool InBounds(const glm::ivec2& cell) const;
+    int Index(const glm::ivec2& cell) const { return cell.y * size.x + cell.x; }
+    glm::ivec2 Cell(const int i) const { return {i % size.x, i / size.x}; }
+    static glm::ivec2 Neighbor(const glm::ivec2& cell, int dir);
+
+    // Of the edge between `cell` and its neighbor in `dir`, walked towards the goal:
+    // from the cell when rooted at the goal, to it when rooted at the start
+    float Cost(const glm::ivec2& cell, int dir) const;
+
+    float Heuristic(const glm::ivec2& a, const glm::ivec2& b) const;
+    Key CalculateKey(int i) const;
+    // min over the neighbors of (Cost() + g)
+    float MinNeighbor(int i) const;
+    // Queues the cell if inconsistent, dequeues it otherwise
+    void UpdateVertex(int i);
+    // Recomputes rhs (except at the root), then UpdateVertex()
+    void Repair(int i);
+
+    // Pops the dead entries, then the top key (infinite if empty)
+    Key TopKey();
+    // False if stopped
+    bool ComputeShortestPath(const std::stop_token& stop, size_t& nodesExpanded);
+
+    // Allocates the state and seeds the root
+    void Initialize();
+
+private:
+    std::shared_ptr<const EdgeCostGrid> grid;
+    glm::ivec2 size = {0, 0};
+    PathFinder::Connectivity connectivity = PathFinder::Connectivity::C8;
+    float heuristicScale = 0.0f;
+
+    glm::ivec2 start = {-1, -1};
+    glm::ivec2 goal = {-1, -1};
+    bool rootedAtStart = false;
+    glm::ivec2 last = {-1, -1}; // Tip when km was last updated
+    float km = 0.0f;
+    bool initialized = false;
+
+    std::vector<float> g;
+    std::vector<float> rhs;
+    std::vector<Key> keys;       // Key the cell is queued with
+    std::vector<uint8_t> queued; // In the queue (its live entry has keys[i])
+    std::vector<Entry> heap;
+};
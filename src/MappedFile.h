@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file. The OS pages it in on first access and can evict
+// it under memory pressure: files larger than RAM are read in place. Move-only.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool Empty() const { return size == 0; }
+
+private:
+    void Unmap();
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
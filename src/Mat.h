@@ -1,11 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "Image.h"
 
+template <typename T>
+class MatView;
+
 template <typename T>
 class Mat {
 public:
@@ -13,25 +20,90 @@ public:
     explicit Mat(const glm::uvec2& size) : size(size), data(size.x * size.y) {}
     Mat(const glm::uvec2& size, const T& value) : size(size), data(size.x * size.y, value) {}
 
+    // Copy of a row-major buffer of size.x * size.y values
+    Mat(const glm::uvec2& size, const T* values) :
+        size(size), data(values, values + static_cast<size_t>(size.x) * size.y) {}
+
     explicit Mat(const Image& img) : size(img.width, img.height), data(size.x * size.y) {
         assert(img.format == Image::Format::I);
         for (uint32_t i = 0; i < data.size(); i++)
             data[i] = img.data[i] / 255.f;
     }
 
+    // A copy has its own edit count
+    Mat(const Mat& other) : size(other.size), data(other.data) {}
+    Mat(Mat&&) noexcept = default;
+    Mat& operator=(const Mat& other) {
+        if (!edits)
+            edits = std::make_unique<std::atomic<uint64_t>>(0);
+        size = other.size;
+        data = other.data;
+        Edited();
+        return *this;
+    }
+    Mat& operator=(Mat&&) noexcept = default;
+
     uint32_t Width() const { return size.x; }
     uint32_t Height() const { return size.y; }
     const glm::uvec2& Size() const { return size; }
 
-    T* Data() { return data.data(); }
+    // The non-const accessors count as an edit: take Data() once before writing many cells
+    T* Data() {
+        Edited();
+        return data.data();
+    }
     const T* Data() const { return data.data(); }
 
     const T& operator()(const uint32_t x, const uint32_t y) const { return data[Index(x, y)]; }
-    T& operator()(const uint32_t x, const uint32_t y) { return data[Index(x, y)]; }
+    T& operator()(const uint32_t x, const uint32_t y) {
+        Edited();
+        return data[Index(x, y)];
+    }
 
     uint32_t Index(const uint32_t x, const uint32_t y) const { return y * size.x + x; }
 
+    // Non-const accesses so far, see MatView::Edits()
+    uint64_t Edits() const { return edits ? edits->load(std::memory_order_relaxed) : 0; }
+
 protected:
+    friend class MatView<T>;
+
+    void Edited() {
+        if (edits)
+            edits->fetch_add(1, std::memory_order_relaxed);
+    }
+
     glm::uvec2 size{0, 0};
     std::vector<T> data;
+    // On the heap, so that the views still reach it once the Mat is moved
+    std::unique_ptr<std::atomic<uint64_t>> edits = std::make_unique<std::atomic<uint64_t>>(0);
+};
+
+// Non-owning, read-only view over a Mat (or any row-major buffer). The viewed data must outlive
+// the view, which is cheap to copy and can be captured by cost functions instead of the Mat.
+template <typename T>
+class MatView {
+public:
+    MatView() = default;
+    MatView(const glm::uvec2& size, const T* data) : size(size), data(data) {}
+    MatView(const Mat<T>& mat) : size(mat.Size()), data(mat.Data()), edits(mat.edits.get()) {}
+
+    uint32_t Width() const { return size.x; }
+    uint32_t Height() const { return size.y; }
+    const glm::uvec2& Size() const { return size; }
+
+    const T* Data() const { return data; }
+
+    const T& operator()(const uint32_t x, const uint32_t y) const { return data[Index(x, y)]; }
+
+    uint32_t Index(const uint32_t x, const uint32_t y) const { return y * size.x + x; }
+
+    // Of the viewed Mat: changes whenever its values may have, e.g. to tell a cached hash of
+    // them is stale. Always 0 over a plain buffer.
+    uint64_t Edits() const { return edits ? edits->load(std::memory_order_relaxed) : 0; }
+
+private:
+    glm::uvec2 size{0, 0};
+    const T* data = nullptr;
+    const std::atomic<uint64_t>* edits = nullptr;
 };
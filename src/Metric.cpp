@@ -1,45 +1,65 @@
 #include "Metric.h"
 
-static constexpr float SQRT_2 = 1.41421356f;
-static constexpr float MAX_FLOAT = std::numeric_limits<float>::max();
+#include "Algorithm.h"
 
-PathFinder::CostFunction Metric::Slope(const Mat<float>& heightMap, float scale) {
-    return [heightMap, scale](const PathFinder::Edge& e) -> float {
-        const float h1 = heightMap(e.x1, e.y1) * scale;
-        const float h2 = heightMap(e.x2, e.y2) * scale;
-        const float dh = std::abs(h2 - h1);
+uint64_t Metric::DistanceCost::Hash() const {
+    constexpr char NAME[] = "Distance";
+    return Algorithm::Hash(NAME, sizeof(NAME));
+}
+
+uint64_t Metric::SlopeCost::Hash() const {
+    constexpr char NAME[] = "Slope";
+    const uint64_t h = Algorithm::Hash(NAME, sizeof(NAME));
+    return Algorithm::Hash(heightMap, Algorithm::Hash(&scale, sizeof(scale), h));
+}
+
+uint64_t Metric::SlopeCost::Key() const {
+    constexpr char NAME[] = "Slope";
+    const float* data = heightMap.Data();
+    const uint64_t edits = heightMap.Edits();
+    uint64_t h = Algorithm::Hash(NAME, sizeof(NAME));
+    h = Algorithm::Hash(&heightMap.Size(), sizeof(heightMap.Size()), h);
+    h = Algorithm::Hash(&data, sizeof(data), h);
+    h = Algorithm::Hash(&edits, sizeof(edits), h);
+    return Algorithm::Hash(&scale, sizeof(scale), h);
+}
+
+uint64_t Metric::TerrainCost::Hash() const {
+    constexpr char NAME[] = "Terrain";
+    return Algorithm::Hash(typeMap, Algorithm::Hash(NAME, sizeof(NAME)));
+}
 
-        const float slope = dh / e.d;
+uint64_t Metric::TerrainCost::Key() const {
+    constexpr char NAME[] = "Terrain";
+    const Terrain::TileType* data = typeMap.Data();
+    const uint64_t edits = typeMap.Edits();
+    uint64_t h = Algorithm::Hash(NAME, sizeof(NAME));
+    h = Algorithm::Hash(&typeMap.Size(), sizeof(typeMap.Size()), h);
+    h = Algorithm::Hash(&data, sizeof(data), h);
+    return Algorithm::Hash(&edits, sizeof(edits), h);
+}
+
+uint64_t Metric::TiledSlopeCost::Hash() const {
+    constexpr char NAME[] = "TiledSlope";
+    const uint64_t h = Algorithm::Hash(NAME, sizeof(NAME));
+    const uint64_t content = terrain->ContentHash();
+    return Algorithm::Hash(&content, sizeof(content), Algorithm::Hash(&scale, sizeof(scale), h));
+}
 
-        constexpr float MAX_SLOPE = 1.0f;
-        return std::clamp(slope / MAX_SLOPE, 0.0f, 1.0f);
-    };
+uint64_t Metric::TiledTerrainCost::Hash() const {
+    constexpr char NAME[] = "TiledTerrain";
+    const uint64_t content = terrain->ContentHash();
+    return Algorithm::Hash(&content, sizeof(content), Algorithm::Hash(NAME, sizeof(NAME)));
+}
+
+PathFinder::CostFunction Metric::Slope(const MatView<float> heightMap, const float scale) {
+    return SlopeCost{heightMap, scale};
 }
 
 PathFinder::CostFunction Metric::Distance() {
-    return [](const PathFinder::Edge& e) -> float {
-        constexpr float MAX_DIST = SQRT_2;
-        return e.d / MAX_DIST;
-    };
-}
-
-PathFinder::CostFunction Metric::Terrain(const Mat<Terrain::TileType>& typeMap) {
-    return [typeMap](const PathFinder::Edge& e) -> float {
-        const auto t1 = typeMap(e.x1, e.y1);
-        const auto t2 = typeMap(e.x2, e.y2);
-
-        // No road start/end in water
-        if (t1 == Terrain::TileType::WATER || t2 == Terrain::TileType::WATER)
-            return MAX_FLOAT;
-
-        if (!e.isBridgeCandidate) {
-            if (t1 == Terrain::TileType::FOREST || t2 == Terrain::TileType::FOREST) {
-                return 10.f;
-            }
-        } else {
-            return e.d * 20.f; // Bridge cost
-        }
-
-        return 0.0f;
-    };
+    return DistanceCost{};
+}
+
+PathFinder::CostFunction Metric::Terrain(const MatView<Terrain::TileType> typeMap) {
+    return TerrainCost{typeMap};
 }
@@ -1,11 +1,117 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
 #include "Mat.h"
 #include "PathFinder.h"
 #include "Terrain.h"
+#include "TiledTerrain.h"
 
 namespace Metric {
-    PathFinder::CostFunction Slope(const Mat<float>& heightMap, float scale);
+    static constexpr float SQRT_2 = 1.41421356f;
+    static constexpr float MAX_FLOAT = std::numeric_limits<float>::max();
+
+    // Cost kernels, inlined by PathFinder::Compute(const Weighted<Costs>&...).
+    // Hash() identifies what a kernel computes (parameters and map contents), so that
+    // EdgeCostCache can tell when baked costs are stale. Key() stands for it where hashing is
+    // costly, from the parameters, the map addresses and their edit counts (MatView::Edits()):
+    // PathFinder::Compute() checks its contraction hierarchy with it on every query, and
+    // hashes the maps only when it changes.
+
+    struct DistanceCost {
+        static constexpr float MAX_DIST = SQRT_2;
+
+        float operator()(const PathFinder::Edge& e) const { return e.d / MAX_DIST; }
+
+        // Admissible A* scale when weighted by `weight` (the other metrics are >= 0)
+        static constexpr float HeuristicScale(const float weight) { return weight / MAX_DIST; }
+
+        uint64_t Hash() const;
+    };
+
+    struct SlopeCost {
+        MatView<float> heightMap;
+        float scale;
+
+        float operator()(const PathFinder::Edge& e) const {
+            return FromHeights(heightMap(e.x1, e.y1) * scale, heightMap(e.x2, e.y2) * scale, e.d);
+        }
+
+        // Scaled heights of both ends
+        static float FromHeights(const float h1, const float h2, const float d) {
+            const float dh = std::abs(h2 - h1);
+
+            const float slope = dh / d;
+
+            constexpr float MAX_SLOPE = 1.0f;
+            return std::clamp(slope / MAX_SLOPE, 0.0f, 1.0f);
+        }
+
+        uint64_t Hash() const;
+        uint64_t Key() const;
+    };
+
+    struct TerrainCost {
+        MatView<Terrain::TileType> typeMap;
+
+        float operator()(const PathFinder::Edge& e) const {
+            return FromTypes(typeMap(e.x1, e.y1), typeMap(e.x2, e.y2), e);
+        }
+
+        // Types of both ends
+        static float FromTypes(const Terrain::TileType t1,
+                               const Terrain::TileType t2,
+                               const PathFinder::Edge& e) {
+            // No road start/end in water
+            if (t1 == Terrain::TileType::WATER || t2 == Terrain::TileType::WATER)
+                return MAX_FLOAT;
+
+            if (!e.isBridgeCandidate) {
+                if (t1 == Terrain::TileType::FOREST || t2 == Terrain::TileType::FOREST) {
+                    return 10.f;
+                }
+            } else {
+                return e.d * 20.f; // Bridge cost
+            }
+
+            return 0.0f;
+        }
+
+        uint64_t Hash() const;
+        uint64_t Key() const;
+    };
+
+    // The same kernels over a memory-mapped terrain, which must outlive them. The tiles are
+    // paged in as the search reaches them.
+
+    struct TiledSlopeCost {
+        const TiledTerrain* terrain;
+        float scale;
+
+        float operator()(const PathFinder::Edge& e) const {
+            return SlopeCost::FromHeights(terrain->Height(e.x1, e.y1) * scale,
+                                          terrain->Height(e.x2, e.y2) * scale, e.d);
+        }
+
+        uint64_t Hash() const;
+    };
+
+    struct TiledTerrainCost {
+        const TiledTerrain* terrain;
+
+        float operator()(const PathFinder::Edge& e) const {
+            return TerrainCost::FromTypes(terrain->Type(e.x1, e.y1), terrain->Type(e.x2, e.y2), e);
+        }
+
+        uint64_t Hash() const;
+    };
+
+    // Type-erased versions, for PathFinder::With().
+    // They only reference the maps: the maps must outlive the returned functions.
+
+    PathFinder::CostFunction Slope(MatView<float> heightMap, float scale);
     PathFinder::CostFunction Distance();
-    PathFinder::CostFunction Terrain(const Mat<Terrain::TileType>& typeMap);
+    PathFinder::CostFunction Terrain(MatView<Terrain::TileType> typeMap);
 } // namespace Metric
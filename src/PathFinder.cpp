@@ -1,27 +1,40 @@
 #include "PathFinder.h"
 
-#include <algorithm>
-#include <random>
-#include <utility>
-
-#include <glm/ext/scalar_constants.hpp>
-
+#include "ContractionHierarchy.h"
 
 PathFinder::Edge::Edge(
     const int x1, const int y1, const int x2, const int y2, const bool bridgeCandidate) :
     x1(x1), y1(y1), x2(x2), y2(y2), d(std::hypotf(x2 - x1, y2 - y1)),
-    isBridgeCandidate(bridgeCandidate) {
+    isBridgeCandidate(bridgeCandidate), dir(-1) {
+}
+
+PathFinder::Edge::Edge(const int x1,
+                       const int y1,
+                       const int x2,
+                       const int y2,
+                       const float d,
+                       const bool bridgeCandidate,
+                       const int dir) :
+    x1(x1), y1(y1), x2(x2), y2(y2), d(d), isBridgeCandidate(bridgeCandidate), dir(dir) {
 }
 
 PathFinder& PathFinder::From(const int x, const int y) {
-    start.x = x;
-    start.y = y;
+    sources.assign(1, {{x, y}, 0.0f});
+    return *this;
+}
+
+PathFinder& PathFinder::From(const std::span<const Source> cells) {
+    sources.assign(cells.begin(), cells.end());
     return *this;
 }
 
 PathFinder& PathFinder::To(const int x, const int y) {
-    end.x = x;
-    end.y = y;
+    targets.assign(1, {x, y});
+    return *this;
+}
+
+PathFinder& PathFinder::To(const std::span<const glm::ivec2> cells) {
+    targets.assign(cells.begin(), cells.end());
     return *this;
 }
 
@@ -46,179 +59,171 @@ PathFinder& PathFinder::AllowBridges(const bool allow) {
     return *this;
 }
 
-PathFinder::Path PathFinder::Compute() {
-    if (!Validate())
-        return {};
+PathFinder& PathFinder::SetBridges(std::shared_ptr<const BridgeNetwork> network) {
+    bridgeNetwork = std::move(network);
+    return *this;
+}
 
-    Mat<float> costs(size, std::numeric_limits<float>::infinity());
-    Mat<int> parent(size, -1);
-    PriorityQueue pq;
-
-    // Init
-    costs(start.x, start.y) = 0.0f;
-    pq.push({start.x, start.y, 0.0f});
-
-    // Directions:
-    int dx[8];
-    int dy[8];
-
-    // clang-format off
-    if (connectivity == Connectivity::C4) {
-        dx[0] = 00; dy[0] = -1;
-        dx[1] = 00; dy[1] = 01;
-        dx[2] = -1; dy[2] = 00;
-        dx[3] = 01; dy[3] = 00;
-    } else if (connectivity == Connectivity::C8) {
-        dx[0] = 00; dy[0] = 01;
-        dx[1] = 00; dy[1] = -1;
-        dx[2] = 01; dy[2] = 00;
-        dx[3] = -1; dy[3] = 00;
-        dx[4] = 01; dy[4] = 01;
-        dx[5] = 01; dy[5] = -1;
-        dx[6] = -1; dy[6] = 01;
-        dx[7] = -1; dy[7] = -1;
-    } else {
-        std::unreachable();
-    }
-    // clang-format on
+PathFinder& PathFinder::SetSearchMode(const SearchMode mode) {
+    searchMode = mode;
+    return *this;
+}
 
-    std::vector<Edge> bridgeCandidates;
-    if (allowBridges) {
-        bridgeCandidates = GenerateBridgeCandidates();
-    }
+PathFinder& PathFinder::SetHeuristicScale(const float scale) {
+    heuristicScale = scale;
+    return *this;
+}
+
+PathFinder& PathFinder::SetBidirectional(const bool enable) {
+    bidirectional = enable;
+    return *this;
+}
+
+PathFinder& PathFinder::SetStopToken(std::stop_token token) {
+    stopToken = std::move(token);
+    return *this;
+}
 
-    while (!pq.empty()) {
-        auto [cx, cy, currentCost] = pq.top();
-        pq.pop();
+PathFinder& PathFinder::SetProgress(std::shared_ptr<Progress> progress) {
+    this->progress = std::move(progress);
+    return *this;
+}
 
-        // Found the destination
-        if (cx == end.x && cy == end.y)
-            break;
+PathFinder& PathFinder::SetQueue(const QueueType type, const float width) {
+    queueType = type;
+    bucketWidth = width;
+    return *this;
+}
 
-        // Skip if we've already found a better path
-        if (currentCost > costs(cx, cy))
-            continue;
+PathFinder& PathFinder::SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> grid) {
+    edgeCosts = std::move(grid);
+    return *this;
+}
 
-        const int parentIdx = Index(cx, cy);
+PathFinder::Path PathFinder::Compute() {
+    SearchWorkspace workspace;
+    return Compute(workspace);
+}
 
-        // Explore neighbors (C4/C8 roads)
-        for (int i = 0; i < static_cast<int>(connectivity); i++) {
-            const int nx = cx + dx[i];
-            const int ny = cy + dy[i];
-            const auto edge = Edge(cx, cy, nx, ny, false);
+PathFinder::Path PathFinder::Compute(SearchWorkspace& workspace) {
+    if (!Validate() || metrics.empty())
+        return {};
 
-            ProcessEdge(edge, currentCost, costs, parent, pq, parentIdx);
+    const auto edgeCost = [this](const Edge& edge) {
+        float cost = 0.0f;
+        for (const auto& [weight, costFunction] : metrics) {
+            cost += weight * costFunction(edge);
         }
+        return cost;
+    };
+    return Search(edgeCost, workspace);
+}
+
+PathFinder::CostField PathFinder::ComputeField(const float budget) {
+    if (!Validate(false) || !(budget >= 0.0f) || metrics.empty())
+        return {};
 
-        // Explore bridge candidates
-        if (allowBridges) {
-            for (const auto& bridge : bridgeCandidates) {
-                if (bridge.x1 == cx && bridge.y1 == cy) {
-                    ProcessEdge(bridge, currentCost, costs, parent, pq, parentIdx);
-                }
-            }
+    const auto edgeCost = [this](const Edge& edge) {
+        float cost = 0.0f;
+        for (const auto& [weight, costFunction] : metrics) {
+            cost += weight * costFunction(edge);
         }
-    }
+        return cost;
+    };
+    return SearchField(edgeCost, budget);
+}
 
-    // No path found
-    if (std::isinf(costs(end.x, end.y)))
+PathFinder::Path PathFinder::CostField::PathTo(const int x, const int y) const {
+    if (x < 0 || y < 0 || x >= static_cast<int>(costs.Width()) ||
+        y >= static_cast<int>(costs.Height()) || std::isinf(costs(x, y)))
         return {};
 
-    // Path reconstruction
     Path path;
-    glm::ivec2 it(end.x, end.y);
-    while (it.x != start.x || it.y != start.y) {
-        path.points.emplace_back(it);
-        const int p = parent(it.x, it.y);
-
-        const int px = p % size.x;
-        const int py = p / size.x;
-        it.x = px;
-        it.y = py;
-    }
-    path.points.emplace_back(start);
-    std::ranges::reverse(path.points);
-    path.cost = costs(end.x, end.y);
+    path.cost = costs(x, y);
+
+    const int width = static_cast<int>(costs.Width());
+    for (int i = static_cast<int>(costs.Index(x, y)); i != -1; i = parents.Data()[i])
+        path.points.emplace_back(glm::ivec2(i % width, i / width));
 
+    std::ranges::reverse(path.points);
     return path;
 }
 
-bool PathFinder::Validate() const {
-    return (start.x >= 0 && start.y >= 0 && end.x >= 0 && end.y >= 0) &&
-        (size.x > 0 && size.y > 0) &&
-        (start.x < size.x && start.y < size.y && end.x < size.x && end.y < size.y) &&
-        !metrics.empty();
+bool PathFinder::Validate(const bool requireTargets) const {
+    if (size.x <= 0 || size.y <= 0)
+        return false;
+
+    // Initial costs must be finite and non-negative: !(cost >= 0) also rejects NaN
+    if (sources.empty() || std::ranges::any_of(sources, [this](const Source& source) {
+            return !InBounds(source.cell.x, source.cell.y) || !(source.cost >= 0.0f) ||
+                std::isinf(source.cost);
+        }))
+        return false;
+
+    if (requireTargets &&
+        (targets.empty() || std::ranges::any_of(targets, [this](const glm::ivec2& target) {
+             return !InBounds(target.x, target.y);
+         })))
+        return false;
+
+    return (!bridgeNetwork || bridgeNetwork->GridSize() == size) &&
+        (!edgeCosts || edgeCosts->Size() == size) && heuristicScale >= 0.0f &&
+        (queueType != QueueType::BUCKET || bucketWidth > 0.0f);
 }
 
-bool PathFinder::InBounds(const int x, const int y) const {
-    return x >= 0 && x < size.x && y >= 0 && y < size.y;
+bool PathFinder::UsesContraction() const {
+    return contraction && sources.size() == 1 && targets.size() == 1 &&
+        sources.front().cost == 0.0f && !allowBridges &&
+        contraction->GetConnectivity() == connectivity && contraction->GridSize() == size;
 }
 
-int PathFinder::Index(const int x, const int y) const {
-    return y * size.x + x;
+PathFinder::Path PathFinder::ComputeContracted(SearchWorkspace& workspace) const {
+    return contraction->Compute(sources.front().cell, targets.front(), workspace);
 }
 
-std::vector<PathFinder::Edge> PathFinder::GenerateBridgeCandidates() const {
-    std::vector<Edge> candidates;
-
-    thread_local std::mt19937 rng(std::random_device{}());
-
-    // TODO: Make this configurable
-    constexpr int minBridgeLength = 50;
-    constexpr int maxBridgeLength = 200;
-    const int numSamples = std::max(100, (size.x * size.y) / 100);
-
-    std::uniform_int_distribution<int> distX(0, size.x - 1);
-    std::uniform_int_distribution<int> distY(0, size.y - 1);
-    std::uniform_int_distribution<int> distLen(minBridgeLength, maxBridgeLength);
+bool PathFinder::MatchesProfile(const ContractionHierarchy& hierarchy, const uint64_t profile) {
+    return hierarchy.Profile() == profile;
+}
 
-    for (int i = 0; i < numSamples; i++) {
-        int x1 = distX(rng);
-        int y1 = distY(rng);
-        const int length = distLen(rng);
+const BridgeNetwork& PathFinder::ResolveBridges(BridgeNetwork& generated) const {
+    if (allowBridges && !bridgeNetwork)
+        generated = BridgeNetwork::Generate(size, {});
+    return allowBridges && bridgeNetwork ? *bridgeNetwork : generated;
+}
 
-        for (int dir = 0; dir < 8; dir++) {
-            const float angle = dir * 2.0f * glm::pi<float>() / 8.0f;
-            int x2 = x1 + static_cast<int>(length * std::cos(angle));
-            int y2 = y1 + static_cast<int>(length * std::sin(angle));
+bool PathFinder::InBounds(const int x, const int y) const {
+    return x >= 0 && x < size.x && y >= 0 && y < size.y;
+}
 
-            if (InBounds(x2, y2)) {
-                candidates.emplace_back(x1, y1, x2, y2, true);
-                candidates.emplace_back(x2, y2, x1, y1, true);
-            }
-        }
+bool PathFinder::Interrupted(const size_t nodesExpanded, const float frontierCost) const {
+    if (progress) {
+        progress->nodesExpanded.store(nodesExpanded, std::memory_order_relaxed);
+        progress->frontierCost.store(frontierCost, std::memory_order_relaxed);
     }
-
-    return candidates;
+    return stopToken.stop_requested();
 }
 
-void PathFinder::ProcessEdge(const Edge& edge,
-                             const float currentCost,
-                             Mat<float>& costs,
-                             Mat<int>& parent,
-                             std::priority_queue<Node, std::vector<Node>, std::greater<>>& pq,
-                             const int parentIndex) {
-    const int nx = edge.x2;
-    const int ny = edge.y2;
-
-    if (!InBounds(nx, ny))
-        return;
-
-    // Calculate edge cost
-    float edgeCost = 0.0f;
-    for (const auto& [weight, costFunction] : metrics) {
-        edgeCost += weight * costFunction(edge);
-    }
+PathFinder::Path PathFinder::ReconstructPath(const Frontier& forward,
+                                             const Frontier* backward,
+                                             const uint32_t meet) const {
+    // No path found
+    if (std::isinf(forward.Cost(meet)))
+        return {};
 
-    if (std::isinf(edgeCost))
-        return;
+    Path path;
 
-    const float newCost = currentCost + edgeCost;
+    // Forward half: meet -> source (no parent), reversed
+    for (int p = static_cast<int>(meet); p != -1; p = forward.Parent(p))
+        path.points.emplace_back(forward.Cell(p));
+    std::ranges::reverse(path.points);
+    path.cost = forward.Cost(meet);
 
-    // Update if better path found
-    if (newCost < costs(nx, ny)) {
-        costs(nx, ny) = newCost;
-        parent(nx, ny) = parentIndex;
-        pq.push({nx, ny, newCost});
+    // Backward half: meet -> target (no parent)
+    if (backward) {
+        for (int p = backward->Parent(meet); p != -1; p = backward->Parent(p))
+            path.points.emplace_back(backward->Cell(p));
+        path.cost += backward->Cost(meet);
     }
+
+    return path;
 }
@@ -1,75 +1,846 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <functional>
-#include <queue>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "Algorithm.h"
+#include "BridgeNetwork.h"
+#include "EdgeCostGrid.h"
 #include "Mat.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+
+class ContractionHierarchy;
 
 class PathFinder {
 public:
-    struct Node {
-        int x, y;
-        float cost;
-
-        bool operator>(const Node& other) const { return cost > other.cost; }
-    };
+    using Node = PriorityQueue::Node;
 
     struct Edge {
         int x1, y1;
         int x2, y2;
         float d;
         bool isBridgeCandidate;
+        int dir; // C8 direction index (see EdgeCostGrid), -1 for bridges
 
         Edge(int x1, int y1, int x2, int y2, bool bridgeCandidate = false);
+        Edge(int x1, int y1, int x2, int y2, float d, bool bridgeCandidate, int dir = -1);
     };
 
     struct Path {
         std::vector<glm::vec2> points;
         float cost = -1.0f;
+        size_t nodesExpanded = 0;
+        bool stopped = false; // Interrupted through SetStopToken(): no path
 
         operator bool() const { return cost != -1.0f; }
     };
 
+    // Cost from the sources to every reached cell, see ComputeField()
+    struct CostField {
+        Mat<float> costs; // Infinity where not reached
+        Mat<int> parents; // Index of the previous cell, -1 at the sources and where not reached
+        size_t nodesExpanded = 0;
+        bool stopped = false; // Interrupted through SetStopToken(): empty field
+
+        // Walks the parents back to the nearest source: any destination, no new search
+        Path PathTo(int x, int y) const;
+
+        operator bool() const { return costs.Width() > 0; }
+    };
+
+    struct Query {
+        glm::ivec2 start;
+        glm::ivec2 end;
+    };
+
+    // Search origin with an initial cost, e.g. the dispatch cost of a depot
+    struct Source {
+        glm::ivec2 cell;
+        float cost = 0.0f;
+    };
+
     using CostFunction = std::function<float(Edge)>;
-    using PriorityQueue = std::priority_queue<Node, std::vector<Node>, std::greater<>>;
 
     struct Metric {
         float weight;
         CostFunction cost;
     };
 
+    // Statically typed metric, see Compute(const Weighted<Costs>&...)
+    template <typename Cost>
+    struct Weighted {
+        float weight;
+        Cost cost;
+    };
+
+    // Published by a running search for other threads, see SetProgress()
+    struct Progress {
+        std::atomic<size_t> nodesExpanded = 0;
+        std::atomic<float> frontierCost = 0.0f; // Queue key of the last expanded cell
+    };
+
+    // Expansions between two stop checks and progress updates
+    static constexpr size_t PROGRESS_INTERVAL = 4096;
+
     enum class Connectivity { C4 = 4, C8 = 8 };
+    enum class SearchMode { DIJKSTRA, A_STAR };
+    enum class QueueType { BINARY_HEAP, QUATERNARY_HEAP, RADIX_HEAP, BUCKET };
 
     PathFinder() = default;
 
     PathFinder& From(int x, int y);
+    // Several sources searched in a single pass: the path starts from the cheapest one,
+    // initial cost included
+    PathFinder& From(std::span<const Source> cells);
     PathFinder& To(int x, int y);
+    // Several targets: the search stops at the cheapest one to reach. The A* heuristic
+    // is a minimum over the targets, so keep their count small with A*.
+    PathFinder& To(std::span<const glm::ivec2> cells);
     PathFinder& Size(int x, int y);
     PathFinder& With(float weight, const CostFunction& f);
     PathFinder& SetConnectivity(Connectivity c);
     PathFinder& AllowBridges(bool allow);
+    // Shared, prebuilt network used when bridges are allowed. Without one, a
+    // network is generated with the default settings on every Compute().
+    PathFinder& SetBridges(std::shared_ptr<const BridgeNetwork> network);
+    PathFinder& SetSearchMode(SearchMode mode);
+    // A* heuristic: lower bound of the cost per unit of distance, e.g.
+    // Metric::DistanceCost::HeuristicScale(distanceWeight). Must not exceed the real cost.
+    PathFinder& SetHeuristicScale(float scale);
+    // Searches from both ends at once. Assumes symmetric edge costs.
+    PathFinder& SetBidirectional(bool enable);
+    // Queue used by the search, see PriorityQueue.h. BUCKET quantizes the costs to
+    // `bucketWidth`, which bounds the error on the returned cost.
+    PathFinder& SetQueue(QueueType type, float bucketWidth = 0.01f);
+    // Baked grid edge costs (see BakeEdgeCosts() and EdgeCostCache). They must come from
+    // the metrics passed to Compute(), which are still evaluated for the bridges. Faster
+    // for costly or type-erased metrics only, see EdgeCostGrid.
+    PathFinder& SetEdgeCosts(std::shared_ptr<const EdgeCostGrid> grid);
+    // Preprocessed router, kept only if it was built for these metrics. Compute() then
+    // answers single source and target queries with the same connectivity, no bridges and
+    // the same metrics from it, whatever the search settings, and falls back to the regular
+    // search otherwise. Call after Size(). The maps are hashed here, and again in Compute()
+    // only when its metrics point to other maps or parameters, or a map was edited since
+    // (see Metric, Key()). Writes through a Mat::Data() pointer taken before this call are
+    // not seen: call it again after those.
+    template <typename... Costs>
+    PathFinder& SetContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy,
+                                        const Weighted<Costs>&... costs);
+    // Grid searches give up (Path::stopped, CostField::stopped) once a stop is requested.
+    // Polled every PROGRESS_INTERVAL expansions. Contraction hierarchy queries are too short
+    // to be interrupted.
+    PathFinder& SetStopToken(std::stop_token token);
+    // Updated every PROGRESS_INTERVAL expansions, e.g. to be shown by the thread waiting
+    // for the result
+    PathFinder& SetProgress(std::shared_ptr<Progress> progress);
 
+    // Slow path: sums the type-erased metrics registered with With()
     Path Compute();
+    Path Compute(SearchWorkspace& workspace);
+
+    // Fused path: the metrics are inlined into a single edge cost kernel
+    template <typename... Costs>
+    Path Compute(const Weighted<Costs>&... costs);
+    template <typename... Costs>
+    Path Compute(SearchWorkspace& workspace, const Weighted<Costs>&... costs);
+
+    // Many queries with the same settings, spread over the pool. From()/To() are ignored
+    // and the paths come back in query order. `workspaces` holds one workspace per worker:
+    // it is resized to the pool size and can be kept for the next batch.
+    template <typename... Costs>
+    std::vector<Path> ComputeBatch(std::span<const Query> queries,
+                                   ThreadPool& pool,
+                                   std::vector<SearchWorkspace>& workspaces,
+                                   const Weighted<Costs>&... costs) const;
+    template <typename... Costs>
+    std::vector<Path> ComputeBatch(std::span<const Query> queries,
+                                   const Weighted<Costs>&... costs) const;
+
+    // One-to-all Dijkstra from the From() sources: runs until every reachable cell is settled,
+    // or until the costs exceed `budget`. To(), the search mode and bidirectional are ignored.
+    CostField ComputeField(float budget = std::numeric_limits<float>::infinity());
+    template <typename... Costs>
+    CostField ComputeField(float budget, const Weighted<Costs>&... costs);
+
+    // Identifies a weight profile on a terrain: the grid size, each weight and each metric
+    // (Hash(), which covers the terrain maps). Linear in the map sizes.
+    template <typename... Costs>
+    static uint64_t ProfileHash(const glm::ivec2& size, const Weighted<Costs>&... costs);
+
+    // Bakes the weighted cost of every C8 edge, rows spread over the pool
+    template <typename... Costs>
+    static EdgeCostGrid BakeEdgeCosts(const glm::ivec2& size,
+                                      ThreadPool& pool,
+                                      const Weighted<Costs>&... costs);
+    // Same, giving up (nullopt) once a stop is requested, checked before each row
+    template <typename... Costs>
+    static std::optional<EdgeCostGrid> BakeEdgeCosts(const glm::ivec2& size,
+                                                     ThreadPool& pool,
+                                                     const std::stop_token& stop,
+                                                     const Weighted<Costs>&... costs);
 
 private:
-    bool Validate() const;
+    // A step index is an EdgeCostGrid direction
+    static constexpr const auto& C8_STEPS = EdgeCostGrid::DIRECTIONS;
+    static constexpr const auto& OPPOSITE = EdgeCostGrid::OPPOSITE;
+
+    using Frontier = SearchWorkspace::Frontier;
+
+    // Of the search grids: the neighbors of a grid cell need no bounds check
+    static constexpr int BORDER = 1;
+
+    bool Validate(bool requireTargets = true) const;
     bool InBounds(int x, int y) const;
-    int Index(int x, int y) const;
+    float Heuristic(int x, int y, std::span<const glm::ivec2> goals) const;
+    // Called every PROGRESS_INTERVAL expansions: publishes the progress, true to stop
+    bool Interrupted(size_t nodesExpanded, float frontierCost) const;
+
+    // True when Compute() can answer from the contraction hierarchy
+    bool UsesContraction() const;
+    Path ComputeContracted(SearchWorkspace& workspace) const;
+    static bool MatchesProfile(const ContractionHierarchy& hierarchy, uint64_t profile);
+    // True when the hierarchy was built for `costs`. The result is kept for the next calls
+    // with the same ProfileKey(): a map is hashed once, not per query.
+    template <typename... Costs>
+    bool MatchesContraction(const Weighted<Costs>&... costs);
+    // Cheap stand-in for ProfileHash(): the metric Key() where defined, else its Hash()
+    template <typename... Costs>
+    static uint64_t ProfileKey(const glm::ivec2& size, const Weighted<Costs>&... costs);
+
+    // The shared network, else one generated with the default settings into `generated`
+    const BridgeNetwork& ResolveBridges(BridgeNetwork& generated) const;
+
+    // Calls run(std::type_identity<Queue>{}) with the queue selected by SetQueue()
+    template <typename Run>
+    decltype(auto) DispatchQueue(const Run& run) const;
+
+    // Calls run(cost), cost reading the grid edges from the baked costs if any
+    template <typename EdgeCost, typename Run>
+    decltype(auto) DispatchEdgeCost(const EdgeCost& edgeCost, const Run& run) const;
 
-    std::vector<Edge> GenerateBridgeCandidates() const;
-    void ProcessEdge(const Edge& edge,
-                     float currentCost,
-                     Mat<float>& costs,
-                     Mat<int>& parent,
-                     PriorityQueue& pq,
-                     int parentIndex);
+    template <typename EdgeCost>
+    Path Search(const EdgeCost& edgeCost, SearchWorkspace& workspace);
+
+    template <typename EdgeCost>
+    CostField SearchField(const EdgeCost& edgeCost, float budget) const;
+
+    template <typename Queue, typename EdgeCost>
+    Path SearchWith(const EdgeCost& edgeCost,
+                    const BridgeNetwork& bridges,
+                    SearchWorkspace& workspace);
+
+    template <typename Queue, typename EdgeCost>
+    Path SearchForward(const EdgeCost& edgeCost,
+                       const BridgeNetwork& bridges,
+                       SearchWorkspace& workspace);
+
+    template <typename Queue, typename EdgeCost>
+    Path SearchBidirectional(const EdgeCost& edgeCost,
+                             const BridgeNetwork& bridges,
+                             SearchWorkspace& workspace);
+
+    template <typename Queue, typename EdgeCost>
+    CostField SearchFieldWith(const EdgeCost& edgeCost,
+                              const BridgeNetwork& bridges,
+                              float budget,
+                              SearchWorkspace& workspace);
+
+    template <typename Queue>
+    Queue& PrepareQueue(Frontier& frontier) const;
+
+    // Pushes every source with its initial cost
+    template <typename Queue>
+    void Seed(Frontier& frontier, Queue& pq) const;
+
+    // visit(edge, next) for the C4/C8 neighbors of `cell`, border included (see Relax()),
+    // then for the bridges leaving it. `next` is the index of edge's second cell.
+    template <typename Visit>
+    void ForEachEdge(const Frontier& frontier,
+                     uint32_t cell,
+                     const glm::ivec2& coords,
+                     const BridgeNetwork& bridges,
+                     const Visit& visit) const;
+
+    // Sets and queues `next` if the edge improves it. Edge costs are non-negative: the cost
+    // is not even evaluated when `next` is already as cheap as the current cell, which
+    // covers the settled cells and the border.
+    template <typename Queue, typename EdgeCost>
+    bool Relax(Frontier& frontier,
+               Queue& pq,
+               uint32_t next,
+               const Edge& edge,
+               const EdgeCost& edgeCost,
+               float currentCost,
+               uint32_t parent);
+
+    // Walks the parents from meet back to a source, then (bidirectional) forward to a target
+    Path ReconstructPath(const Frontier& forward, const Frontier* backward, uint32_t meet) const;
 
 private:
     bool allowBridges = false;
-    glm::ivec2 start = {-1, -1};
-    glm::ivec2 end = {-1, -1};
+    bool bidirectional = false;
+    std::vector<Source> sources;
+    std::vector<glm::ivec2> targets;
     glm::ivec2 size = {-1, -1};
     Connectivity connectivity = Connectivity::C4;
+    SearchMode searchMode = SearchMode::DIJKSTRA;
+    float heuristicScale = 0.0f;
+    QueueType queueType = QueueType::BINARY_HEAP;
+    float bucketWidth = 0.01f;
     std::vector<Metric> metrics;
+    std::shared_ptr<const BridgeNetwork> bridgeNetwork;
+    std::shared_ptr<const EdgeCostGrid> edgeCosts;
+    std::shared_ptr<const ContractionHierarchy> contraction;
+    // Last MatchesContraction() check
+    uint64_t contractionKey = 0;
+    bool contractionMatches = false;
+    std::stop_token stopToken;
+    std::shared_ptr<Progress> progress;
 };
+
+template <typename... Costs>
+PathFinder::Path PathFinder::Compute(const Weighted<Costs>&... costs) {
+    SearchWorkspace workspace;
+    return Compute(workspace, costs...);
+}
+
+template <typename... Costs>
+PathFinder::Path PathFinder::Compute(SearchWorkspace& workspace, const Weighted<Costs>&... costs) {
+    static_assert(sizeof...(Costs) > 0, "PathFinder::Compute() - At least one metric is required");
+
+    if (!Validate())
+        return {};
+    if (UsesContraction() && MatchesContraction(costs...))
+        return ComputeContracted(workspace);
+
+    const auto edgeCost = [&](const Edge& edge) {
+        float cost = 0.0f;
+        ((cost += costs.weight * costs.cost(edge)), ...);
+        return cost;
+    };
+    return Search(edgeCost, workspace);
+}
+
+template <typename... Costs>
+PathFinder&
+PathFinder::SetContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy,
+                                    const Weighted<Costs>&... costs) {
+    contraction = std::move(hierarchy);
+    if (contraction && !MatchesProfile(*contraction, ProfileHash(size, costs...)))
+        contraction.reset();
+    contractionKey = ProfileKey(size, costs...);
+    contractionMatches = contraction != nullptr;
+    return *this;
+}
+
+template <typename... Costs>
+bool PathFinder::MatchesContraction(const Weighted<Costs>&... costs) {
+    const uint64_t key = ProfileKey(size, costs...);
+    if (key != contractionKey) {
+        contractionKey = key;
+        contractionMatches = MatchesProfile(*contraction, ProfileHash(size, costs...));
+    }
+    return contractionMatches;
+}
+
+template <typename... Costs>
+uint64_t PathFinder::ProfileHash(const glm::ivec2& size, const Weighted<Costs>&... costs) {
+    uint64_t hash = Algorithm::Hash(&size, sizeof(size));
+    ((hash = Algorithm::Hash(&costs.weight, sizeof(costs.weight), hash ^ costs.cost.Hash())),
+     ...);
+    return hash;
+}
+
+template <typename... Costs>
+uint64_t PathFinder::ProfileKey(const glm::ivec2& size, const Weighted<Costs>&... costs) {
+    const auto key = [](const auto& cost) {
+        if constexpr (requires { cost.Key(); })
+            return cost.Key();
+        else
+            return cost.Hash();
+    };
+    uint64_t hash = Algorithm::Hash(&size, sizeof(size));
+    ((hash = Algorithm::Hash(&costs.weight, sizeof(costs.weight), hash ^ key(costs.cost))), ...);
+    return hash;
+}
+
+template <typename... Costs>
+std::vector<PathFinder::Path>
+PathFinder::ComputeBatch(const std::span<const Query> queries,
+                         ThreadPool& pool,
+                         std::vector<SearchWorkspace>& workspaces,
+                         const Weighted<Costs>&... costs) const {
+    // One finder per worker: the settings and the metrics are read-only, only the
+    // endpoints change. Bridges are generated once for the whole batch if needed.
+    PathFinder shared = *this;
+    if (shared.allowBridges && !shared.bridgeNetwork && size.x > 0 && size.y > 0)
+        shared.bridgeNetwork = std::make_shared<BridgeNetwork>(BridgeNetwork::Generate(size, {}));
+    // Checked once for the whole batch, not once per worker
+    if (shared.contraction)
+        shared.MatchesContraction(costs...);
+
+    std::vector<PathFinder> finders(pool.ThreadCount(), shared);
+    workspaces.resize(pool.ThreadCount());
+
+    std::vector<Path> paths(queries.size());
+    pool.ParallelFor(queries.size(), [&](const size_t i, const unsigned worker) {
+        const auto& [queryStart, queryEnd] = queries[i];
+        paths[i] = finders[worker]
+                       .From(queryStart.x, queryStart.y)
+                       .To(queryEnd.x, queryEnd.y)
+                       .Compute(workspaces[worker], costs...);
+    });
+    return paths;
+}
+
+template <typename... Costs>
+std::vector<PathFinder::Path> PathFinder::ComputeBatch(const std::span<const Query> queries,
+                                                       const Weighted<Costs>&... costs) const {
+    ThreadPool pool;
+    std::vector<SearchWorkspace> workspaces;
+    return ComputeBatch(queries, pool, workspaces, costs...);
+}
+
+inline float PathFinder::Heuristic(const int x,
+                                  const int y,
+                                  const std::span<const glm::ivec2> goals) const {
+    if (searchMode == SearchMode::DIJKSTRA)
+        return 0.0f;
+
+    // Distance to the nearest goal: still a consistent lower bound
+    float distance = std::numeric_limits<float>::infinity();
+    for (const auto& goal : goals) {
+        const float dx = static_cast<float>(std::abs(x - goal.x));
+        const float dy = static_cast<float>(std::abs(y - goal.y));
+
+        // Bridges can shortcut any grid path: only the straight line is a lower bound
+        if (allowBridges)
+            distance = std::min(distance, std::sqrt(dx * dx + dy * dy));
+        else if (connectivity == Connectivity::C4)
+            distance = std::min(distance, dx + dy); // Manhattan
+        else
+            distance = std::min(distance, std::max(dx, dy) +
+                                    (1.41421356f - 1.0f) * std::min(dx, dy)); // Octile
+    }
+
+    return heuristicScale * distance;
+}
+
+template <typename... Costs>
+PathFinder::CostField PathFinder::ComputeField(const float budget,
+                                               const Weighted<Costs>&... costs) {
+    static_assert(sizeof...(Costs) > 0,
+                  "PathFinder::ComputeField() - At least one metric is required");
+
+    if (!Validate(false) || !(budget >= 0.0f))
+        return {};
+
+    const auto edgeCost = [&](const Edge& edge) {
+        float cost = 0.0f;
+        ((cost += costs.weight * costs.cost(edge)), ...);
+        return cost;
+    };
+    return SearchField(edgeCost, budget);
+}
+
+template <typename Run>
+decltype(auto) PathFinder::DispatchQueue(const Run& run) const {
+    using namespace PriorityQueue;
+
+    switch (queueType) {
+    case QueueType::BINARY_HEAP:
+        return run(std::type_identity<BinaryHeap>{});
+    case QueueType::QUATERNARY_HEAP:
+        return run(std::type_identity<QuaternaryHeap>{});
+    case QueueType::RADIX_HEAP:
+        return run(std::type_identity<RadixHeap>{});
+    case QueueType::BUCKET:
+        return run(std::type_identity<BucketQueue>{});
+    }
+    std::unreachable();
+}
+
+template <typename EdgeCost, typename Run>
+decltype(auto) PathFinder::DispatchEdgeCost(const EdgeCost& edgeCost, const Run& run) const {
+    if (!edgeCosts)
+        return run(edgeCost);
+
+    const EdgeCostGrid& grid = *edgeCosts;
+    return run([&](const Edge& edge) {
+        return edge.dir >= 0 ? grid(edge.x1, edge.y1, edge.dir) : edgeCost(edge);
+    });
+}
+
+template <typename... Costs>
+EdgeCostGrid PathFinder::BakeEdgeCosts(const glm::ivec2& size,
+                                       ThreadPool& pool,
+                                       const Weighted<Costs>&... costs) {
+    return *BakeEdgeCosts(size, pool, std::stop_token{}, costs...);
+}
+
+template <typename... Costs>
+std::optional<EdgeCostGrid> PathFinder::BakeEdgeCosts(const glm::ivec2& size,
+                                                      ThreadPool& pool,
+                                                      const std::stop_token& stop,
+                                                      const Weighted<Costs>&... costs) {
+    static_assert(sizeof...(Costs) > 0,
+                  "PathFinder::BakeEdgeCosts() - At least one metric is required");
+
+    EdgeCostGrid grid(size);
+
+    // The rows left once stopped are skipped, the grid is then dropped
+    pool.ParallelFor(size.y, [&](const size_t row, unsigned) {
+        if (stop.stop_requested())
+            return;
+
+        const int y = static_cast<int>(row);
+
+        for (int dir = 0; dir < EdgeCostGrid::DIRECTION_COUNT; dir++) {
+            const auto& [dx, dy, d] = C8_STEPS[dir];
+            if (y + dy < 0 || y + dy >= size.y)
+                continue;
+
+            // Only the cells whose neighbor is inside: no bounds check in the loop.
+            // The others stay infinite.
+            const int xBegin = std::max(0, -dx);
+            const int xEnd = std::min(size.x, size.x - dx);
+            for (int x = xBegin; x < xEnd; x++) {
+                const Edge edge(x, y, x + dx, y + dy, d, false, dir);
+                float cost = 0.0f;
+                ((cost += costs.weight * costs.cost(edge)), ...);
+                grid.Cell(x, y)[dir] = cost;
+            }
+        }
+    });
+
+    if (stop.stop_requested())
+        return std::nullopt;
+    return grid;
+}
+
+template <typename EdgeCost>
+PathFinder::Path PathFinder::Search(const EdgeCost& edgeCost, SearchWorkspace& workspace) {
+    BridgeNetwork generatedBridges;
+    const BridgeNetwork& bridges = ResolveBridges(generatedBridges);
+
+    return DispatchEdgeCost(edgeCost, [&](const auto& cost) {
+        return DispatchQueue([&]<typename Queue>(std::type_identity<Queue>) {
+            return SearchWith<Queue>(cost, bridges, workspace);
+        });
+    });
+}
+
+template <typename EdgeCost>
+PathFinder::CostField PathFinder::SearchField(const EdgeCost& edgeCost, const float budget) const {
+    // No target to aim for: plain Dijkstra
+    PathFinder dijkstra = *this;
+    dijkstra.searchMode = SearchMode::DIJKSTRA;
+
+    BridgeNetwork generatedBridges;
+    const BridgeNetwork& bridges = ResolveBridges(generatedBridges);
+    SearchWorkspace workspace;
+
+    return DispatchEdgeCost(edgeCost, [&](const auto& cost) {
+        return DispatchQueue([&]<typename Queue>(std::type_identity<Queue>) {
+            return dijkstra.SearchFieldWith<Queue>(cost, bridges, budget, workspace);
+        });
+    });
+}
+
+template <typename Queue, typename EdgeCost>
+PathFinder::Path PathFinder::SearchWith(const EdgeCost& edgeCost,
+                                        const BridgeNetwork& bridges,
+                                        SearchWorkspace& workspace) {
+    if (bidirectional)
+        return SearchBidirectional<Queue>(edgeCost, bridges, workspace);
+    return SearchForward<Queue>(edgeCost, bridges, workspace);
+}
+
+template <typename Queue>
+Queue& PathFinder::PrepareQueue(Frontier& frontier) const {
+    auto& pq = frontier.GetQueue<Queue>();
+    if constexpr (std::is_same_v<Queue, PriorityQueue::BucketQueue>)
+        pq.SetWidth(bucketWidth);
+    pq.Reset(frontier.CellCount());
+    return pq;
+}
+
+template <typename Queue>
+void PathFinder::Seed(Frontier& frontier, Queue& pq) const {
+    for (const auto& [cell, cost] : sources) {
+        const uint32_t i = frontier.Index(cell.x, cell.y);
+        if (cost < frontier.Cost(i)) {
+            frontier.Set(i, cost, -1);
+            pq.Push({i, cost + Heuristic(cell.x, cell.y, frontier.goals)});
+        }
+    }
+}
+
+template <typename Queue, typename EdgeCost>
+PathFinder::Path PathFinder::SearchForward(const EdgeCost& edgeCost,
+                                           const BridgeNetwork& bridges,
+                                           SearchWorkspace& workspace) {
+    Frontier& forward = workspace.forward;
+    forward.Reset(size, targets, BORDER);
+    Queue& pq = PrepareQueue<Queue>(forward);
+    Seed(forward, pq);
+    size_t nodesExpanded = 0;
+    bool reached = false;
+    uint32_t cell = 0;
+    bool stopped = false;
+
+    while (!pq.Empty()) {
+        const float key = pq.Top().cost;
+        cell = pq.Top().cell;
+        pq.Pop();
+
+        // Skip if we've already found a better path
+        const glm::ivec2 coords = forward.Cell(cell);
+        const float currentCost = forward.Cost(cell);
+        if (key > currentCost + Heuristic(coords.x, coords.y, targets))
+            continue;
+
+        // Found the cheapest destination
+        if (forward.IsGoal(cell)) {
+            reached = true;
+            break;
+        }
+
+        nodesExpanded++;
+        if (nodesExpanded % PROGRESS_INTERVAL == 0 && Interrupted(nodesExpanded, key)) {
+            stopped = true;
+            break;
+        }
+
+        ForEachEdge(forward, cell, coords, bridges, [&](const Edge& edge, const uint32_t next) {
+            Relax(forward, pq, next, edge, edgeCost, currentCost, cell);
+        });
+    }
+
+    Path path;
+    if (reached)
+        path = ReconstructPath(forward, nullptr, cell);
+    path.nodesExpanded = nodesExpanded;
+    path.stopped = stopped;
+    return path;
+}
+
+template <typename Queue, typename EdgeCost>
+PathFinder::CostField PathFinder::SearchFieldWith(const EdgeCost& edgeCost,
+                                                  const BridgeNetwork& bridges,
+                                                  const float budget,
+                                                  SearchWorkspace& workspace) {
+    Frontier& frontier = workspace.forward;
+    frontier.Reset(size, {}, BORDER);
+    Queue& pq = PrepareQueue<Queue>(frontier);
+    Seed(frontier, pq);
+    size_t nodesExpanded = 0;
+
+    while (!pq.Empty()) {
+        const auto [cell, cost] = pq.Top();
+
+        // Every remaining cell is over budget
+        if (cost > budget)
+            break;
+        pq.Pop();
+
+        const float currentCost = frontier.Cost(cell);
+        if (cost > currentCost)
+            continue;
+
+        nodesExpanded++;
+        if (nodesExpanded % PROGRESS_INTERVAL == 0 && Interrupted(nodesExpanded, cost)) {
+            CostField stopped;
+            stopped.nodesExpanded = nodesExpanded;
+            stopped.stopped = true;
+            return stopped;
+        }
+
+        const glm::ivec2 coords = frontier.Cell(cell);
+        ForEachEdge(frontier, cell, coords, bridges, [&](const Edge& edge, const uint32_t next) {
+            Relax(frontier, pq, next, edge, edgeCost, currentCost, cell);
+        });
+    }
+
+    // Cells over budget only hold tentative costs: report them as not reached.
+    // The parents go back to plain row-major indices.
+    CostField field;
+    field.costs = Mat<float>(glm::uvec2(size), std::numeric_limits<float>::infinity());
+    field.parents = Mat<int>(glm::uvec2(size), -1);
+    field.nodesExpanded = nodesExpanded;
+
+    float* costs = field.costs.Data();
+    int* parents = field.parents.Data();
+    for (int y = 0; y < size.y; y++) {
+        for (int x = 0; x < size.x; x++) {
+            const uint32_t i = frontier.Index(x, y);
+            const float cost = frontier.Cost(i);
+            if (!(cost <= budget))
+                continue;
+
+            const uint32_t cell = field.costs.Index(x, y);
+            costs[cell] = cost;
+            if (const int parent = frontier.Parent(i); parent != -1) {
+                const glm::ivec2 p = frontier.Cell(parent);
+                parents[cell] = static_cast<int>(field.parents.Index(p.x, p.y));
+            }
+        }
+    }
+    return field;
+}
+
+template <typename Queue, typename EdgeCost>
+PathFinder::Path PathFinder::SearchBidirectional(const EdgeCost& edgeCost,
+                                                 const BridgeNetwork& bridges,
+                                                 SearchWorkspace& workspace) {
+    std::vector<glm::ivec2> sourceCells;
+    for (const auto& source : sources)
+        sourceCells.push_back(source.cell);
+
+    // The backward search starts from the targets and aims for the sources
+    Frontier& forward = workspace.forward;
+    Frontier& backward = workspace.backward;
+    forward.Reset(size, targets, BORDER);
+    backward.Reset(size, sourceCells, BORDER);
+    Queue& forwardQueue = PrepareQueue<Queue>(forward);
+    Queue& backwardQueue = PrepareQueue<Queue>(backward);
+    Seed(forward, forwardQueue);
+    for (const auto& target : targets) {
+        const uint32_t i = backward.Index(target.x, target.y);
+        backward.Set(i, 0.0f, -1);
+        backwardQueue.Push({i, Heuristic(target.x, target.y, sourceCells)});
+    }
+    size_t nodesExpanded = 0;
+    bool stopped = false;
+
+    // Best complete path found so far, through the meeting cell. A source may be a target.
+    // Both directions share the same indices.
+    float best = std::numeric_limits<float>::infinity();
+    uint32_t meet = forward.Index(sources.front().cell.x, sources.front().cell.y);
+    for (const auto& [cell, cost] : sources) {
+        const uint32_t i = forward.Index(cell.x, cell.y);
+        if (forward.Cost(i) + backward.Cost(i) < best) {
+            best = forward.Cost(i) + backward.Cost(i);
+            meet = i;
+        }
+    }
+
+    while (!forwardQueue.Empty() && !backwardQueue.Empty()) {
+        // Stop once no unexplored path can beat the best one. The queue tops
+        // are lower bounds of the remaining paths (stale entries only lower them).
+        const float topForward = forwardQueue.Top().cost;
+        const float topBackward = backwardQueue.Top().cost;
+        if (searchMode == SearchMode::DIJKSTRA) {
+            if (topForward + topBackward >= best)
+                break;
+        } else if (std::max(topForward, topBackward) >= best) {
+            break;
+        }
+
+        // Expand the smallest frontier
+        const bool isForward = forwardQueue.Size() <= backwardQueue.Size();
+        Frontier& self = isForward ? forward : backward;
+        const Frontier& other = isForward ? backward : forward;
+        Queue& pq = isForward ? forwardQueue : backwardQueue;
+
+        const auto [cell, key] = pq.Top();
+        pq.Pop();
+
+        const glm::ivec2 coords = self.Cell(cell);
+        const float currentCost = self.Cost(cell);
+        if (key > currentCost + Heuristic(coords.x, coords.y, self.goals))
+            continue;
+
+        nodesExpanded++;
+        if (nodesExpanded % PROGRESS_INTERVAL == 0 && Interrupted(nodesExpanded, key)) {
+            stopped = true; // `best` may not be optimal yet
+            break;
+        }
+
+        // The backward search walks the edges in reverse
+        const auto cost = [&](const Edge& edge) {
+            return isForward
+                ? edgeCost(edge)
+                : edgeCost(Edge(edge.x2, edge.y2, edge.x1, edge.y1, edge.d, edge.isBridgeCandidate,
+                                edge.dir >= 0 ? OPPOSITE[edge.dir] : -1));
+        };
+
+        ForEachEdge(self, cell, coords, bridges, [&](const Edge& edge, const uint32_t next) {
+            // A total only changes when one of its halves improves
+            if (!Relax(self, pq, next, edge, cost, currentCost, cell))
+                return;
+
+            const float total = self.Cost(next) + other.Cost(next);
+            if (total < best) {
+                best = total;
+                meet = next;
+            }
+        });
+    }
+
+    Path path;
+    if (!stopped && !std::isinf(best)) {
+        path = ReconstructPath(forward, &backward, meet);
+        path.cost = best;
+    }
+    path.nodesExpanded = nodesExpanded;
+    path.stopped = stopped;
+    return path;
+}
+
+template <typename Visit>
+void PathFinder::ForEachEdge(const Frontier& frontier,
+                             const uint32_t cell,
+                             const glm::ivec2& coords,
+                             const BridgeNetwork& bridges,
+                             const Visit& visit) const {
+    const auto [x, y] = coords;
+
+    // Neighbors (C4/C8 roads)
+    for (int i = 0; i < static_cast<int>(connectivity); i++) {
+        const auto& [dx, dy, d] = C8_STEPS[i];
+        visit(Edge(x, y, x + dx, y + dy, d, false, i), frontier.Neighbor(cell, i));
+    }
+
+    // Bridge candidates leaving this cell
+    for (const auto& [bx, by, length] : bridges.From(x, y)) {
+        visit(Edge(x, y, bx, by, length, true), frontier.Index(bx, by));
+    }
+}
+
+template <typename Queue, typename EdgeCost>
+bool PathFinder::Relax(Frontier& frontier,
+                       Queue& pq,
+                       const uint32_t next,
+                       const Edge& edge,
+                       const EdgeCost& edgeCost,
+                       const float currentCost,
+                       const uint32_t parent) {
+    if (!(currentCost < frontier.Cost(next)))
+        return false;
+
+    const float cost = edgeCost(edge);
+    if (std::isinf(cost))
+        return false;
+
+    const float newCost = currentCost + cost;
+
+    // Update if better path found
+    if (newCost < frontier.Cost(next)) {
+        frontier.Set(next, newCost, static_cast<int>(parent));
+        pq.Push({next, newCost + Heuristic(edge.x2, edge.y2, frontier.goals)});
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Min-priority queues for PathFinder. They share one interface (Reset, Push, Top,
+// Pop, Empty, Size) so the search can be instantiated on any of them. Keys are the
+// node costs, which are never negative. Reset() keeps the allocated storage.
+namespace PriorityQueue {
+
+    // 8 bytes: the cell is a packed index of the search grid, see SearchWorkspace::Frontier
+    struct Node {
+        uint32_t cell;
+        float cost;
+
+        bool operator>(const Node& other) const { return cost > other.cost; }
+    };
+    static_assert(sizeof(Node) == 8);
+
+    // Binary heap with lazy deletion: a cell may be queued several times
+    class BinaryHeap {
+    public:
+        void Reset(size_t) { heap.clear(); }
+
+        void Push(const Node& node) {
+            heap.push_back(node);
+            std::ranges::push_heap(heap, std::greater<>());
+        }
+
+        const Node& Top() const { return heap.front(); }
+
+        void Pop() {
+            std::ranges::pop_heap(heap, std::greater<>());
+            heap.pop_back();
+        }
+
+        bool Empty() const { return heap.empty(); }
+        size_t Size() const { return heap.size(); }
+
+    private:
+        std::vector<Node> heap;
+    };
+
+    // 4-ary heap indexed by cell: each cell is queued at most once and pushing a
+    // queued cell with a lower cost is a decrease-key. Shallower than a binary heap.
+    class QuaternaryHeap {
+    public:
+        void Reset(const size_t cellCount) {
+            if (position.size() != cellCount) {
+                position.assign(cellCount, NONE);
+            } else {
+                for (const auto& node : heap)
+                    position[node.cell] = NONE;
+            }
+
+            heap.clear();
+        }
+
+        void Push(const Node& node) {
+            uint32_t p = position[node.cell];
+
+            if (p == NONE) {
+                p = static_cast<uint32_t>(heap.size());
+                heap.push_back(node);
+            } else if (node.cost < heap[p].cost) {
+                heap[p] = node;
+            } else {
+                return;
+            }
+            SiftUp(p);
+        }
+
+        const Node& Top() const { return heap.front(); }
+
+        void Pop() {
+            position[heap.front().cell] = NONE;
+
+            const Node last = heap.back();
+            heap.pop_back();
+            if (!heap.empty()) {
+                heap.front() = last;
+                SiftDown(0);
+            }
+        }
+
+        bool Empty() const { return heap.empty(); }
+        size_t Size() const { return heap.size(); }
+
+    private:
+        void SiftUp(uint32_t p) {
+            const Node node = heap[p];
+            while (p > 0) {
+                const uint32_t parent = (p - 1) / 4;
+                if (heap[parent].cost <= node.cost)
+                    break;
+                heap[p] = heap[parent];
+                position[heap[p].cell] = p;
+                p = parent;
+            }
+            heap[p] = node;
+            position[node.cell] = p;
+        }
+
+        void SiftDown(uint32_t p) {
+            const Node node = heap[p];
+            const auto n = static_cast<uint32_t>(heap.size());
+            while (true) {
+                const uint32_t first = 4 * p + 1;
+                if (first >= n)
+                    break;
+
+                uint32_t best = first;
+                const uint32_t last = std::min(first + 4, n);
+                for (uint32_t c = first + 1; c < last; c++) {
+                    if (heap[c].cost < heap[best].cost)
+                        best = c;
+                }
+
+                if (heap[best].cost >= node.cost)
+                    break;
+                heap[p] = heap[best];
+                position[heap[p].cell] = p;
+                p = best;
+            }
+            heap[p] = node;
+            position[node.cell] = p;
+        }
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        std::vector<Node> heap;
+        std::vector<uint32_t> position; // Heap slot of each cell, NONE if not queued
+    };
+
+    // Monotone radix heap: the popped keys never decrease, which holds for Dijkstra
+    // and for A* with a consistent heuristic. Non-negative floats compare like their
+    // bit patterns, so buckets are chosen on the highest bit differing from the last
+    // popped key. Keys pushed slightly below it (float rounding) are treated as equal.
+    class RadixHeap {
+    public:
+        void Reset(size_t) {
+            for (auto& bucket : buckets)
+                bucket.clear();
+            last = 0;
+            count = 0;
+        }
+
+        void Push(const Node& node) {
+            buckets[Bucket(Key(node))].push_back(node);
+            count++;
+        }
+
+        const Node& Top() {
+            if (buckets[0].empty())
+                Redistribute();
+            return buckets[0].back();
+        }
+
+        void Pop() {
+            if (buckets[0].empty())
+                Redistribute();
+            buckets[0].pop_back();
+            count--;
+        }
+
+        bool Empty() const { return count == 0; }
+        size_t Size() const { return count; }
+
+    private:
+        uint32_t Key(const Node& node) const {
+            return std::max(std::bit_cast<uint32_t>(node.cost), last);
+        }
+
+        size_t Bucket(const uint32_t key) const {
+            return key == last ? 0 : 32 - std::countl_zero(key ^ last);
+        }
+
+        void Redistribute() {
+            size_t i = 1;
+            while (buckets[i].empty())
+                i++;
+
+            auto& bucket = buckets[i];
+            uint32_t newLast = UINT32_MAX;
+            for (const auto& node : bucket)
+                newLast = std::min(newLast, Key(node));
+            last = newLast;
+
+            // Every entry lands in a lower bucket
+            for (const auto& node : bucket)
+                buckets[Bucket(Key(node))].push_back(node);
+            bucket.clear();
+        }
+
+    private:
+        std::array<std::vector<Node>, 33> buckets;
+        uint32_t last = 0;
+        size_t count = 0;
+    };
+
+    // Dial's bucket queue on costs quantized to `width`: O(1) push and amortized
+    // O(1) pop. Nodes within one bucket pop in any order, so the search stays
+    // exact per node (entries are re-expanded when improved) but may stop at the
+    // destination with a cost up to about `width` above the optimum.
+    // A circular window of buckets is kept; farther costs wait in an overflow list.
+    class BucketQueue {
+    public:
+        BucketQueue() : buckets(BUCKET_COUNT) {}
+
+        void SetWidth(const float w) { width = w; }
+
+        void Reset(size_t) {
+            for (auto& bucket : buckets)
+                bucket.clear();
+            overflow.clear();
+            overflowMin = UINT64_MAX;
+            current = 0;
+            inWindow = 0;
+        }
+
+        void Push(const Node& node) {
+            const uint64_t b = std::max(Bucket(node), current);
+            if (b < current + BUCKET_COUNT) {
+                buckets[b & MASK].push_back(node);
+                inWindow++;
+            } else {
+                overflow.push_back(node);
+                overflowMin = std::min(overflowMin, b);
+            }
+        }
+
+        const Node& Top() {
+            Advance();
+            return buckets[current & MASK].back();
+        }
+
+        void Pop() {
+            Advance();
+            buckets[current & MASK].pop_back();
+            inWindow--;
+        }
+
+        bool Empty() const { return inWindow == 0 && overflow.empty(); }
+        size_t Size() const { return inWindow + overflow.size(); }
+
+    private:
+        // Clamped: near Metric::MAX_FLOAT the quotient exceeds any integer. The costs past
+        // LAST_BUCKET share it and pop in any order.
+        uint64_t Bucket(const Node& node) const {
+            const float b = node.cost / width;
+            return b < static_cast<float>(LAST_BUCKET) ? static_cast<uint64_t>(b) : LAST_BUCKET;
+        }
+
+        // Moves `current` to the smallest non-empty bucket. The window entries are
+        // always below overflowMin, so the overflow only matters once in range.
+        void Advance() {
+            if (inWindow == 0)
+                current = overflowMin;
+            if (overflowMin < current + BUCKET_COUNT)
+                Spill();
+            while (buckets[current & MASK].empty())
+                current++;
+        }
+
+        // Moves the overflowed entries that now fit in the window
+        void Spill() {
+            size_t kept = 0;
+            overflowMin = UINT64_MAX;
+            for (const auto& node : overflow) {
+                const uint64_t b = Bucket(node);
+                if (b < current + BUCKET_COUNT) {
+                    buckets[b & MASK].push_back(node);
+                    inWindow++;
+                } else {
+                    overflow[kept++] = node;
+                    overflowMin = std::min(overflowMin, b);
+                }
+            }
+            overflow.resize(kept);
+        }
+
+    private:
+        static constexpr uint64_t BUCKET_COUNT = 1 << 12;
+        static constexpr uint64_t MASK = BUCKET_COUNT - 1;
+        // A power of two, exact in float, far enough from UINT64_MAX for current + BUCKET_COUNT
+        static constexpr uint64_t LAST_BUCKET = uint64_t{1} << 62;
+
+        float width = 0.01f;
+        std::vector<std::vector<Node>> buckets;
+        std::vector<Node> overflow;
+        uint64_t overflowMin = UINT64_MAX;
+        uint64_t current = 0;
+        size_t inWindow = 0;
+    };
+
+} // namespace PriorityQueue
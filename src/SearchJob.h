@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "PathFinder.h"
+
+// A search on its own thread, for interactive callers. The task owns copies of everything it
+// reads (the configured finder, the metrics...): the caller is free to edit its own state
+// meanwhile. Starting a task pre-empts the running one: it is stopped and its result dropped,
+// so the latest request wins and only waits for the old search to notice (at most
+// PathFinder::PROGRESS_INTERVAL expansions). Tasks never overlap.
+template <typename Result>
+class SearchJob {
+public:
+    // Runs on the job thread. Hand both to the finder: SetStopToken(), SetProgress().
+    using Task =
+        std::function<Result(std::stop_token, const std::shared_ptr<PathFinder::Progress>&)>;
+
+    SearchJob() = default;
+    SearchJob(const SearchJob&) = delete;
+    SearchJob& operator=(const SearchJob&) = delete;
+    ~SearchJob() { Cancel(); }
+
+    void Start(Task task) {
+        Cancel();
+
+        std::promise<Result> promise;
+        result = promise.get_future();
+        progress = std::make_shared<PathFinder::Progress>();
+        startTime = std::chrono::steady_clock::now();
+
+        thread = std::jthread([task = std::move(task), promise = std::move(promise),
+                               progress = progress](const std::stop_token& stop) mutable {
+            try {
+                promise.set_value(task(stop, progress));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+    }
+
+    // Stops the running task, if any, and waits for it. Its result is dropped.
+    void Cancel() {
+        if (thread.joinable()) {
+            thread.request_stop();
+            thread.join();
+        }
+        if (result.valid()) {
+            result = {};
+            endTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    bool Running() const { return result.valid(); }
+
+    // The result of the task once it finished, a single time. Rethrows its exception.
+    std::optional<Result> Poll() {
+        if (!result.valid() ||
+            result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return std::nullopt;
+
+        endTime = std::chrono::steady_clock::now();
+        thread.join();
+        return result.get();
+    }
+
+    // Of the running task, else of the last one
+    const PathFinder::Progress& GetProgress() const { return *progress; }
+
+    // Since Start(), until the task was polled or cancelled
+    double ElapsedSec() const {
+        const auto end = Running() ? std::chrono::steady_clock::now() : endTime;
+        return std::chrono::duration<double>(end - startTime).count();
+    }
+
+private:
+    std::jthread thread;
+    std::future<Result> result;
+    std::shared_ptr<PathFinder::Progress> progress = std::make_shared<PathFinder::Progress>();
+    std::chrono::steady_clock::time_point startTime, endTime;
+};
@@ -0,0 +1,52 @@
+#include "SearchWorkspace.h"
+
+#include <algorithm>
+
+void SearchWorkspace::Frontier::Reset(const glm::ivec2& size,
+                                      const std::span<const glm::ivec2> goals,
+                                      const int borderWidth) {
+    const glm::ivec2 padded = size + 2 * borderWidth;
+    const size_t cellCount = static_cast<size_t>(padded.x) * padded.y;
+
+    if (stamps.size() != cellCount) {
+        stamps.assign(cellCount, 0);
+        costs.resize(cellCount);
+        parents.resize(cellCount);
+        epoch = 0;
+    }
+
+    // Full clear only when the epoch wraps around
+    if (++epoch == 0) {
+        std::ranges::fill(stamps, 0);
+        epoch = 1;
+    }
+
+    border = borderWidth;
+    stride = static_cast<uint32_t>(padded.x);
+    for (int dir = 0; dir < EdgeCostGrid::DIRECTION_COUNT; dir++) {
+        const auto& [dx, dy, d] = EdgeCostGrid::DIRECTIONS[dir];
+        offsets[dir] = static_cast<uint32_t>(dy * padded.x + dx);
+    }
+
+    // The frame, below any cost: a relaxation never improves it
+    const auto block = [&](const int x, const int y) {
+        Set(static_cast<uint32_t>(y * padded.x + x), -std::numeric_limits<float>::infinity(), -1);
+    };
+    for (int b = 0; b < border; b++) {
+        for (int x = 0; x < padded.x; x++) {
+            block(x, b);
+            block(x, padded.y - 1 - b);
+        }
+        for (int y = border; y < padded.y - border; y++) {
+            block(b, y);
+            block(padded.x - 1 - b, y);
+        }
+    }
+
+    this->goals.assign(goals.begin(), goals.end());
+
+    goalIndices.clear();
+    for (const auto& goal : goals)
+        goalIndices.push_back(Index(goal.x, goal.y));
+    std::ranges::sort(goalIndices);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EdgeCostGrid.h"
+#include "PriorityQueue.h"
+
+// Search state reused between queries. Passing the same workspace to consecutive
+// PathFinder::Compute() calls avoids reallocating the grids and the queues, and
+// resetting it is O(1): cells are generation-stamped, so a cell whose stamp is not
+// the current epoch reads as unvisited. Only the queue types actually used allocate.
+//
+// A workspace must not be used by two searches at the same time.
+class SearchWorkspace {
+public:
+    // One search direction, on packed row-major cell indices. With a border, the grid is
+    // framed by cells whose cost reads -infinity: every neighbor of a grid cell has an index,
+    // and nothing can improve the border, so the grid searches need no bounds check.
+    // Tiled and Z-order grids miss the cache less but are no faster below 1024x1024,
+    // see the grid-layout bench.
+    class Frontier {
+    public:
+        // goals: the cells this direction aims for, read by the heuristic.
+        // border: 1 for the grid searches, 0 for plain indices (y * size.x + x)
+        void Reset(const glm::ivec2& size, std::span<const glm::ivec2> goals, int border = 0);
+
+        uint32_t Index(const int x, const int y) const {
+            return static_cast<uint32_t>((y + border) * stride + x + border);
+        }
+
+        glm::ivec2 Cell(const uint32_t i) const {
+            return {static_cast<int>(i % stride) - border, static_cast<int>(i / stride) - border};
+        }
+
+        // Neighbor in EdgeCostGrid direction `dir`
+        uint32_t Neighbor(const uint32_t i, const int dir) const { return i + offsets[dir]; }
+
+        // Including the border
+        size_t CellCount() const { return stamps.size(); }
+
+        float Cost(const uint32_t i) const {
+            return stamps[i] == epoch ? costs[i] : std::numeric_limits<float>::infinity();
+        }
+
+        int Parent(const uint32_t i) const { return stamps[i] == epoch ? parents[i] : -1; }
+
+        void Set(const uint32_t i, const float cost, const int parent) {
+            stamps[i] = epoch;
+            costs[i] = cost;
+            parents[i] = parent;
+        }
+
+        bool IsGoal(const uint32_t i) const { return std::ranges::binary_search(goalIndices, i); }
+
+        template <typename Queue>
+        Queue& GetQueue() {
+            using namespace PriorityQueue;
+
+            // clang-format off
+            if constexpr      (std::is_same_v<Queue, BinaryHeap>)     return binaryHeap;
+            else if constexpr (std::is_same_v<Queue, QuaternaryHeap>) return quaternaryHeap;
+            else if constexpr (std::is_same_v<Queue, RadixHeap>)      return radixHeap;
+            else {
+                static_assert(std::is_same_v<Queue, BucketQueue>, "Unsupported queue type");
+                return bucketQueue;
+            }
+            // clang-format on
+        }
+
+        std::vector<glm::ivec2> goals;
+
+    private:
+        int border = 0;
+        uint32_t stride = 0;
+        std::array<uint32_t, EdgeCostGrid::DIRECTION_COUNT> offsets{}; // Wrap for negative steps
+
+        uint32_t epoch = 0;
+        std::vector<uint32_t> stamps;
+        std::vector<float> costs;
+        std::vector<int> parents;
+        std::vector<uint32_t> goalIndices; // Sorted
+
+        PriorityQueue::BinaryHeap binaryHeap;
+        PriorityQueue::QuaternaryHeap quaternaryHeap;
+        PriorityQueue::RadixHeap radixHeap;
+        PriorityQueue::BucketQueue bucketQueue;
+    };
+
+    SearchWorkspace() = default;
+
+    Frontier forward;
+    Frontier backward;
+};
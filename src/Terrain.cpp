@@ -1,53 +1,118 @@
 #include "Terrain.h"
 
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include <stb/stb_image.h>
+
 #include "Algorithm.h"
+#include "HeightMap.h"
 
+// Type map pixels, 8-bit, in the row order of the height map
+static std::shared_ptr<const stbi_uc> DecodeTypes(const std::filesystem::path& path,
+                                                  glm::uvec2& size) {
+    stbi_set_flip_vertically_on_load(true);
 
-Terrain Terrain::Load(const std::filesystem::path& heightPath,
-                      const std::filesystem::path& typePath,
-                      const glm::vec2 worldSize,
-                      const float heightScale,
-                      const float waterHeight,
-                      const glm::vec3& origin) {
-    // Load height data (required)
-    const auto heightData = Image::FromFile(heightPath, Image::Format::I);
-    if (!heightData.has_value())
-        throw std::runtime_error("Terrain::Load() - Failed to load height image");
-
-    // Load type data (optional)
-    std::optional<Image> typeData;
-    if (!typePath.empty()) {
-        typeData = Image::FromFile(typePath, Image::Format::I);
-        if (!typeData.has_value())
-            throw std::runtime_error("Terrain::Load() - Failed to load type image");
-
-        if (heightData->width != typeData->width || heightData->height != typeData->height)
-            throw std::runtime_error("Terrain::Load() - Incoherent sizes");
-    }
+    int w, h, bpp;
+    stbi_uc* pixels = stbi_load(path.string().c_str(), &w, &h, &bpp, 1);
+    if (!pixels)
+        throw std::runtime_error("Terrain::Load() - Failed to load type image");
+
+    size = {static_cast<uint32_t>(w), static_cast<uint32_t>(h)};
+    return {pixels, stbi_image_free};
+}
+
+static Terrain Load(const std::filesystem::path& heightPath,
+                    const std::filesystem::path& typePath,
+                    ThreadPool* pool,
+                    const glm::vec2 worldSize,
+                    const float heightScale,
+                    const float waterHeight,
+                    const glm::vec3& origin) {
+    using Clock = std::chrono::steady_clock;
+    const auto Seconds = [](const Clock::time_point from) {
+        return std::chrono::duration<double>(Clock::now() - from).count();
+    };
+    const auto start = Clock::now();
 
     Terrain ret;
-    ret.heightMap = Mat<float>(*heightData);
-    ret.typeMap = Mat<TileType>(ret.heightMap.Size(), TileType::NORMAL);
-
-    for (int y = 0; y < ret.heightMap.Size().y; y++) {
-        for (int x = 0; x < ret.heightMap.Size().x; x++) {
-            if (ret.heightMap(x, y) * heightScale <= waterHeight) {
-                ret.typeMap(x, y) = TileType::WATER;
-            } else if (typeData.has_value() && (*typeData)(x, y) == 0) {
-                ret.typeMap(x, y) = TileType::FOREST;
-            }
+
+    // Height (required) and type (optional) files, decoded at once on a pool
+    HeightMap::Decoded heights;
+    std::shared_ptr<const stbi_uc> types;
+    glm::uvec2 typeSize{0, 0};
+
+    const auto decode = [&](const size_t file) {
+        const auto t0 = Clock::now();
+        if (file == 0) {
+            heights = HeightMap::Decode(heightPath);
+            ret.loadTimings.heightDecodeSec = Seconds(t0);
+        } else if (!typePath.empty()) {
+            types = DecodeTypes(typePath, typeSize);
+            ret.loadTimings.typeDecodeSec = Seconds(t0);
         }
+    };
+    if (pool) {
+        pool->ParallelFor(2, [&](const size_t file, unsigned) { decode(file); });
+    } else {
+        decode(0);
+        decode(1);
     }
 
+    if (types && typeSize != heights.size)
+        throw std::runtime_error("Terrain::Load() - Incoherent sizes");
+
+    // Normalization and classification in one pass: each row is classified while still in cache
+    const auto t0 = Clock::now();
+    const uint32_t width = heights.size.x;
+    ret.typeMap = Mat<Terrain::TileType>(heights.size);
+    ret.heightMap = HeightMap::Convert(
+        std::move(heights), pool, [&](const uint32_t y, const float* row) {
+            Terrain::TileType* rowTypes = &ret.typeMap(0, y);
+            const stbi_uc* rowPixels = types ? types.get() + static_cast<size_t>(y) * width
+                                             : nullptr;
+
+            for (uint32_t x = 0; x < width; x++) {
+                if (row[x] * heightScale <= waterHeight)
+                    rowTypes[x] = Terrain::TileType::WATER;
+                else if (rowPixels && rowPixels[x] == 0)
+                    rowTypes[x] = Terrain::TileType::FOREST;
+                else
+                    rowTypes[x] = Terrain::TileType::NORMAL;
+            }
+        });
+    ret.loadTimings.convertSec = Seconds(t0);
+
     ret.dimensions = ret.heightMap.Size();
     ret.origin = origin;
     ret.worldSize = worldSize;
     ret.heightScale = heightScale;
     ret.waterHeight = waterHeight;
 
+    ret.loadTimings.totalSec = Seconds(start);
     return ret;
 }
 
+Terrain Terrain::Load(const std::filesystem::path& heightPath,
+                      const std::filesystem::path& typePath,
+                      const glm::vec2 worldSize,
+                      const float heightScale,
+                      const float waterHeight,
+                      const glm::vec3& origin) {
+    return ::Load(heightPath, typePath, nullptr, worldSize, heightScale, waterHeight, origin);
+}
+
+Terrain Terrain::Load(const std::filesystem::path& heightPath,
+                      const std::filesystem::path& typePath,
+                      ThreadPool& pool,
+                      const glm::vec2 worldSize,
+                      const float heightScale,
+                      const float waterHeight,
+                      const glm::vec3& origin) {
+    return ::Load(heightPath, typePath, &pool, worldSize, heightScale, waterHeight, origin);
+}
+
 float Terrain::CellSizeX() const {
     return worldSize.x / static_cast<float>(dimensions.x - 1);
 }
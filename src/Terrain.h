@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Mat.h"
+#include "ThreadPool.h"
 
 struct Terrain {
     enum class TileType : uint8_t { NORMAL = 0, WATER = 1, FOREST = 2 };
@@ -15,8 +16,25 @@ struct Terrain {
     float heightScale;
     float waterHeight;
 
+    // Wall-clock time of the stages of Load(), to see the startup cost of large maps
+    struct LoadTimings {
+        double heightDecodeSec = 0.0; // Read and decompressed
+        double typeDecodeSec = 0.0;
+        double convertSec = 0.0;      // Normalization and classification, fused per row
+        double totalSec = 0.0;
+    } loadTimings;
+
+    static Terrain Load(const std::filesystem::path& heightPath,
+                        const std::filesystem::path& typePath,
+                        glm::vec2 worldSize,
+                        float heightScale,
+                        float waterHeight = -1.f,
+                        const glm::vec3& origin = glm::vec3(0.f));
+
+    // Decodes both files at once, then converts the rows in blocks spread over the workers
     static Terrain Load(const std::filesystem::path& heightPath,
                         const std::filesystem::path& typePath,
+                        ThreadPool& pool,
                         glm::vec2 worldSize,
                         float heightScale,
                         float waterHeight = -1.f,
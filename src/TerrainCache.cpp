@@ -0,0 +1,167 @@
+#include "TerrainCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "Algorithm.h"
+#include "BinaryIO.h"
+#include "MappedFile.h"
+
+namespace {
+
+    constexpr uint32_t FILE_MAGIC = 0x43524554; // "TERC"
+    constexpr uint32_t FILE_VERSION = 2;
+
+    // Followed by the heights, normals and types, row-major: the 1-byte types last, so that
+    // the float arrays stay 4-byte aligned
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t width;
+        uint32_t height;
+        float heightScale;
+        float waterHeight;
+    };
+    static_assert(sizeof(FileHeader) % alignof(float) == 0);
+
+    size_t PayloadSize(const uint32_t width, const uint32_t height) {
+        const size_t cellCount = static_cast<size_t>(width) * height;
+        return cellCount * (sizeof(float) + sizeof(Terrain::TileType) + sizeof(glm::vec3));
+    }
+
+    uint64_t HashFile(const std::filesystem::path& path, const uint64_t hash) {
+        const MappedFile file(path);
+        const uint64_t size = file.Size();
+        return Algorithm::Hash(file.Data(), size, Algorithm::Hash(&size, sizeof(size), hash));
+    }
+
+} // namespace
+
+uint64_t TerrainCache::Key(const std::filesystem::path& heightPath,
+                           const std::filesystem::path& typePath,
+                           const float heightScale,
+                           const float waterHeight) {
+    uint64_t hash = Algorithm::Hash(&FILE_VERSION, sizeof(FILE_VERSION));
+    hash = HashFile(heightPath, hash);
+
+    auto headerPath = heightPath;
+    if (std::filesystem::exists(headerPath.replace_extension(".hdr")))
+        hash = HashFile(headerPath, hash);
+
+    // An empty type file and no type file are different inputs
+    const bool hasTypes = !typePath.empty();
+    hash = Algorithm::Hash(&hasTypes, sizeof(hasTypes), hash);
+    if (hasTypes)
+        hash = HashFile(typePath, hash);
+
+    hash = Algorithm::Hash(&heightScale, sizeof(heightScale), hash);
+    return Algorithm::Hash(&waterHeight, sizeof(waterHeight), hash);
+}
+
+TerrainCache TerrainCache::LoadOrBuild(const std::filesystem::path& path,
+                                       const std::filesystem::path& heightPath,
+                                       const std::filesystem::path& typePath,
+                                       ThreadPool& pool,
+                                       const glm::vec2 worldSize,
+                                       const float heightScale,
+                                       const float waterHeight,
+                                       const glm::vec3& origin) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t key = Key(heightPath, typePath, heightScale, waterHeight);
+
+    if (std::filesystem::exists(path)) {
+        // A stale or unreadable file is simply rebuilt
+        try {
+            auto loaded = Load(path, key);
+            loaded.terrain.worldSize = worldSize;
+            loaded.terrain.origin = origin;
+            loaded.terrain.loadTimings.totalSec =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return loaded;
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    TerrainCache built;
+    built.terrain =
+        Terrain::Load(heightPath, typePath, pool, worldSize, heightScale, waterHeight, origin);
+    built.builtNormals = Algorithm::NormalMap(built.terrain.heightMap, heightScale, pool);
+    built.normals = built.builtNormals;
+    built.Save(path, key);
+    return built;
+}
+
+void TerrainCache::Save(const std::filesystem::path& path, const uint64_t key) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("TerrainCache::Save() - Failed to open " + path.string());
+
+    const auto& size = terrain.heightMap.Size();
+    FileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.key = key;
+    header.width = size.x;
+    header.height = size.y;
+    header.heightScale = terrain.heightScale;
+    header.waterHeight = terrain.waterHeight;
+    BinaryIO::Write(out, header);
+
+    const size_t cellCount = static_cast<size_t>(size.x) * size.y;
+    out.write(reinterpret_cast<const char*>(terrain.heightMap.Data()),
+              static_cast<std::streamsize>(cellCount * sizeof(float)));
+    out.write(reinterpret_cast<const char*>(normals.Data()),
+              static_cast<std::streamsize>(cellCount * sizeof(glm::vec3)));
+    out.write(reinterpret_cast<const char*>(terrain.typeMap.Data()),
+              static_cast<std::streamsize>(cellCount * sizeof(Terrain::TileType)));
+
+    if (!out)
+        throw std::runtime_error("TerrainCache::Save() - Failed to write " + path.string());
+}
+
+TerrainCache TerrainCache::Load(const std::filesystem::path& path, const uint64_t key) {
+    TerrainCache ret;
+    ret.file = MappedFile(path);
+
+    FileHeader header{};
+    if (ret.file.Size() < sizeof(header))
+        throw std::runtime_error("TerrainCache::Load() - Not a terrain cache");
+    std::memcpy(&header, ret.file.Data(), sizeof(header));
+
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+        throw std::runtime_error("TerrainCache::Load() - Not a terrain cache");
+    if (header.key != key)
+        throw std::runtime_error("TerrainCache::Load() - Stale cache");
+    if (header.width == 0 || header.height == 0 ||
+        ret.file.Size() != sizeof(header) + PayloadSize(header.width, header.height))
+        throw std::runtime_error("TerrainCache::Load() - Corrupted file");
+
+    const glm::uvec2 size(header.width, header.height);
+    const size_t cellCount = static_cast<size_t>(size.x) * size.y;
+
+    // The searches need owned maps: copied out. The normals only go to the GPU: left in place.
+    // The mapping is page-aligned and the header 32 bytes: the heights and normals are
+    // 4-byte aligned.
+    const uint8_t* p = ret.file.Data() + sizeof(header);
+    ret.terrain.heightMap = Mat<float>(size, reinterpret_cast<const float*>(p));
+    p += cellCount * sizeof(float);
+    ret.normals = MatView<glm::vec3>(size, reinterpret_cast<const glm::vec3*>(p));
+    p += cellCount * sizeof(glm::vec3);
+    ret.terrain.typeMap =
+        Mat<Terrain::TileType>(size, reinterpret_cast<const Terrain::TileType*>(p));
+
+    // Guards the searches against a corrupted file
+    const auto* types = ret.terrain.typeMap.Data();
+    for (size_t i = 0; i < cellCount; i++)
+        if (static_cast<uint8_t>(types[i]) > static_cast<uint8_t>(Terrain::TileType::FOREST))
+            throw std::runtime_error("TerrainCache::Load() - Corrupted file");
+
+    ret.hit = true;
+    ret.terrain.dimensions = size;
+    ret.terrain.heightScale = header.heightScale;
+    ret.terrain.waterHeight = header.waterHeight;
+    return ret;
+}
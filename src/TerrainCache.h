@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "Mat.h"
+#include "Terrain.h"
+#include "ThreadPool.h"
+
+// Terrain::Load() and its normal map, saved for the next runs. The file is keyed by the contents
+// of the input files, the height scale and the water height: any change rebuilds it. A hit maps
+// the file instead: no decoding, classification or normals to compute.
+//
+// The routing preprocessing has its own cache files (ClusterHierarchy, ContractionHierarchy),
+// keyed by the same map contents.
+class TerrainCache {
+public:
+    Terrain terrain;
+
+    // Algorithm::NormalMap(heightMap, heightScale). On a hit, a view into the mapped file:
+    // valid while this object lives (moves included), never copied to the heap.
+    MatView<glm::vec3> normals;
+
+    // Whether the maps were read from the cache file
+    bool hit = false;
+
+    // Loads `path` if it holds these inputs and settings, else loads the terrain, computes
+    // the normals and saves both there. worldSize and origin are not part of the key.
+    static TerrainCache LoadOrBuild(const std::filesystem::path& path,
+                                    const std::filesystem::path& heightPath,
+                                    const std::filesystem::path& typePath,
+                                    ThreadPool& pool,
+                                    glm::vec2 worldSize,
+                                    float heightScale,
+                                    float waterHeight = -1.f,
+                                    const glm::vec3& origin = glm::vec3(0.f));
+
+    // Of the input files (and the .hdr of a raw grid) and the settings
+    static uint64_t Key(const std::filesystem::path& heightPath,
+                        const std::filesystem::path& typePath,
+                        float heightScale,
+                        float waterHeight);
+
+private:
+    // Native binary file: a cache for this machine, not an exchange format
+    void Save(const std::filesystem::path& path, uint64_t key) const;
+
+    // Throws if the file is unreadable or holds another key
+    static TerrainCache Load(const std::filesystem::path& path, uint64_t key);
+
+private:
+    MappedFile file;             // On a hit
+    Mat<glm::vec3> builtNormals; // On a miss
+};
@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < threadCount; i++)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    for (unsigned i = 0; i < threadCount; i++)
+        threads.emplace_back(&ThreadPool::Run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void ThreadPool::ParallelFor(const size_t count,
+                             const std::function<void(size_t, unsigned)>& fn) {
+    if (count == 0)
+        return;
+
+    {
+        std::lock_guard lock(mutex);
+        task = &fn;
+        error = nullptr;
+        remaining = count;
+
+        // Contiguous blocks: neighbouring indices tend to touch the same memory
+        const size_t n = queues.size();
+        for (size_t w = 0; w < n; w++) {
+            std::lock_guard queueLock(queues[w]->mutex);
+            for (size_t i = w * count / n; i < (w + 1) * count / n; i++)
+                queues[w]->indices.push_back(i);
+        }
+        generation++;
+    }
+    wake.notify_all();
+
+    std::unique_lock lock(mutex);
+    done.wait(lock, [this]() { return remaining == 0; });
+    task = nullptr;
+
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void ThreadPool::Run(const unsigned worker) {
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        size_t index;
+        while (Next(worker, index)) {
+            try {
+                (*task)(index, worker);
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+}
+
+bool ThreadPool::Next(const unsigned worker, size_t& index) {
+    // Own block first, front to back
+    {
+        auto& own = *queues[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.indices.empty()) {
+            index = own.indices.front();
+            own.indices.pop_front();
+            return true;
+        }
+    }
+
+    // Then steal from the back of the others
+    for (size_t k = 1; k < queues.size(); k++) {
+        auto& victim = *queues[(worker + k) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.indices.empty()) {
+            index = victim.indices.back();
+            victim.indices.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index ranges. Each worker starts on its own
+// contiguous block of indices and, once done, steals from the back of the other
+// blocks, so uneven tasks (short and long routes) still keep every core busy.
+class ThreadPool {
+public:
+    // threadCount == 0 uses the number of hardware threads
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned ThreadCount() const { return static_cast<unsigned>(threads.size()); }
+
+    // Runs task(index, worker) for every index in [0, count) and blocks until all
+    // are done. worker is in [0, ThreadCount()), usable to pick per-thread state.
+    // The first exception thrown by a task is rethrown here.
+    // Not reentrant: a task must not call ParallelFor on the same pool.
+    void ParallelFor(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> indices;
+    };
+
+    void Run(unsigned worker);
+    bool Next(unsigned worker, size_t& index);
+
+private:
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    const std::function<void(size_t, unsigned)>* task = nullptr;
+    std::atomic<size_t> remaining = 0;
+    std::exception_ptr error;
+};
@@ -0,0 +1,157 @@
+#include "TiledTerrain.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "Algorithm.h"
+#include "BinaryIO.h"
+
+namespace {
+
+    constexpr uint32_t FILE_MAGIC = 0x544D4548; // "HEMT"
+    constexpr uint32_t FILE_VERSION = 1;
+
+    // The tiles start on a page boundary
+    constexpr size_t HEADER_SIZE = 4096;
+    constexpr uint32_t MIN_TILE_SIZE = 64;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileSize;
+        float heightOffset;
+        float heightStep;
+        float heightScale;
+        float waterHeight;
+        uint32_t reserved;
+        uint64_t contentHash;
+    };
+    static_assert(sizeof(FileHeader) <= HEADER_SIZE);
+
+    // Heights then types
+    size_t TileBytes(const uint32_t tileSize) {
+        return static_cast<size_t>(tileSize) * tileSize * (sizeof(uint16_t) + sizeof(uint8_t));
+    }
+
+} // namespace
+
+void TiledTerrain::Write(const Terrain& terrain,
+                         const std::filesystem::path& path,
+                         const uint32_t tileSize) {
+    if (tileSize < MIN_TILE_SIZE || !std::has_single_bit(tileSize))
+        throw std::runtime_error("TiledTerrain::Write() - Tile size must be a power of two, "
+                                 "at least 64");
+
+    const auto& heights = terrain.heightMap;
+    const auto& types = terrain.typeMap;
+    if (heights.Width() == 0 || heights.Height() == 0)
+        throw std::runtime_error("TiledTerrain::Write() - Empty terrain");
+
+    // [0, 1] unless the map goes out of it
+    const float* first = heights.Data();
+    const float* last = first + static_cast<size_t>(heights.Width()) * heights.Height();
+    const float low = std::min(0.0f, *std::min_element(first, last));
+    const float high = std::max(1.0f, *std::max_element(first, last));
+
+    FileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.width = heights.Width();
+    header.height = heights.Height();
+    header.tileSize = tileSize;
+    header.heightOffset = low;
+    header.heightStep = (high - low) / 65535.0f;
+    header.heightScale = terrain.heightScale;
+    header.waterHeight = terrain.waterHeight;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("TiledTerrain::Write() - Failed to open " + path.string());
+
+    // Header last, once the hash is known
+    const std::vector<char> headerBlock(HEADER_SIZE, 0);
+    out.write(headerBlock.data(), static_cast<std::streamsize>(headerBlock.size()));
+
+    const uint32_t tilesX = (header.width + tileSize - 1) / tileSize;
+    const uint32_t tilesY = (header.height + tileSize - 1) / tileSize;
+    std::vector<uint8_t> tile(TileBytes(tileSize));
+    auto* tileHeights = reinterpret_cast<uint16_t*>(tile.data());
+    uint8_t* tileTypes = tile.data() + 2 * tileSize * tileSize;
+
+    // Dimensions, tile size and quantization, then the tiles
+    uint64_t hash = Algorithm::Hash(&header.width, offsetof(FileHeader, heightScale) -
+                                        offsetof(FileHeader, width));
+
+    for (uint32_t ty = 0; ty < tilesY; ty++) {
+        for (uint32_t tx = 0; tx < tilesX; tx++) {
+            std::ranges::fill(tile, uint8_t{0});
+
+            const uint32_t x0 = tx * tileSize, y0 = ty * tileSize;
+            const uint32_t x1 = std::min(x0 + tileSize, header.width);
+            const uint32_t y1 = std::min(y0 + tileSize, header.height);
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    const uint32_t i = (y - y0) * tileSize + (x - x0);
+                    const float normalized = (heights(x, y) - low) / (high - low);
+                    tileHeights[i] = static_cast<uint16_t>(std::lround(normalized * 65535.0f));
+                    tileTypes[i] = static_cast<uint8_t>(types(x, y));
+                }
+            }
+
+            out.write(reinterpret_cast<const char*>(tile.data()),
+                      static_cast<std::streamsize>(tile.size()));
+            hash = Algorithm::Hash(tile.data(), tile.size(), hash);
+        }
+    }
+
+    header.contentHash = hash;
+    out.seekp(0);
+    BinaryIO::Write(out, header);
+
+    if (!out)
+        throw std::runtime_error("TiledTerrain::Write() - Failed to write " + path.string());
+}
+
+TiledTerrain TiledTerrain::Open(const std::filesystem::path& path) {
+    TiledTerrain ret;
+    ret.file = MappedFile(path);
+
+    FileHeader header{};
+    if (ret.file.Size() < HEADER_SIZE)
+        throw std::runtime_error("TiledTerrain::Open() - Not a tiled terrain");
+    std::memcpy(&header, ret.file.Data(), sizeof(header));
+
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+        throw std::runtime_error("TiledTerrain::Open() - Not a tiled terrain");
+    if (header.width == 0 || header.height == 0 || header.tileSize < MIN_TILE_SIZE ||
+        !std::has_single_bit(header.tileSize))
+        throw std::runtime_error("TiledTerrain::Open() - Invalid header");
+
+    ret.size = {header.width, header.height};
+    ret.tileSize = header.tileSize;
+    ret.tileShift = static_cast<uint32_t>(std::countr_zero(header.tileSize));
+    ret.tileMask = header.tileSize - 1;
+    ret.tilesX = (header.width + header.tileSize - 1) / header.tileSize;
+    ret.tileBytes = TileBytes(header.tileSize);
+
+    const uint32_t tilesY = (header.height + header.tileSize - 1) / header.tileSize;
+    if (ret.file.Size() < HEADER_SIZE + static_cast<size_t>(ret.tilesX) * tilesY * ret.tileBytes)
+        throw std::runtime_error("TiledTerrain::Open() - Truncated file");
+
+    ret.tiles = ret.file.Data() + HEADER_SIZE;
+    ret.heightOffset = header.heightOffset;
+    ret.heightStep = header.heightStep;
+    ret.heightScale = header.heightScale;
+    ret.waterHeight = header.waterHeight;
+    ret.contentHash = header.contentHash;
+
+    return ret;
+}
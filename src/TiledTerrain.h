@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "Terrain.h"
+
+// Terrain stored as square tiles in a file that is memory-mapped, not loaded: only the tiles
+// a search or a lookup touches are paged in, so maps larger than RAM can be routed.
+//
+// Each tile holds its heights (uint16, quantized over the height range of the map: lossless
+// for the 8 and 16-bit PNG inputs) then its types (one byte each), and starts on a page boundary.
+// The border tiles are padded to the full tile size.
+class TiledTerrain {
+public:
+    static constexpr uint32_t DEFAULT_TILE_SIZE = 256;
+
+    TiledTerrain() = default;
+
+    // Converts a loaded terrain. `tileSize`: a power of two, at least 64.
+    static void Write(const Terrain& terrain,
+                      const std::filesystem::path& path,
+                      uint32_t tileSize = DEFAULT_TILE_SIZE);
+
+    static TiledTerrain Open(const std::filesystem::path& path);
+
+    // Normalized height, as in Terrain::heightMap
+    float Height(const uint32_t x, const uint32_t y) const {
+        const auto* heights = reinterpret_cast<const uint16_t*>(Tile(x, y));
+        return heightOffset + static_cast<float>(heights[LocalIndex(x, y)]) * heightStep;
+    }
+
+    Terrain::TileType Type(const uint32_t x, const uint32_t y) const {
+        const uint8_t* types = Tile(x, y) + 2 * tileSize * tileSize;
+        return static_cast<Terrain::TileType>(types[LocalIndex(x, y)]);
+    }
+
+    const glm::uvec2& Size() const { return size; }
+    uint32_t TileSize() const { return tileSize; }
+    float HeightScale() const { return heightScale; }
+    float WaterHeight() const { return waterHeight; }
+
+    // Of the tile data, computed when written: identifies the map without reading it
+    uint64_t ContentHash() const { return contentHash; }
+
+    bool Empty() const { return file.Empty(); }
+
+private:
+    const uint8_t* Tile(const uint32_t x, const uint32_t y) const {
+        const size_t tile = static_cast<size_t>(y >> tileShift) * tilesX + (x >> tileShift);
+        return tiles + tile * tileBytes;
+    }
+
+    uint32_t LocalIndex(const uint32_t x, const uint32_t y) const {
+        return ((y & tileMask) << tileShift) | (x & tileMask);
+    }
+
+private:
+    MappedFile file;
+    const uint8_t* tiles = nullptr;
+
+    glm::uvec2 size{0, 0};
+    uint32_t tileSize = 0;
+    uint32_t tileShift = 0;
+    uint32_t tileMask = 0;
+    uint32_t tilesX = 0;
+    size_t tileBytes = 0;
+
+    float heightOffset = 0.0f;
+    float heightStep = 0.0f;
+    float heightScale = 1.0f;
+    float waterHeight = -1.0f;
+    uint64_t contentHash = 0;
+};
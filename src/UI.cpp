@@ -285,16 +285,9 @@ static ImU32 SaturateColor(const ImU32 color, const float factor) {
 }
 
 bool ImGui::ComputeButton(const char* label, const bool computing, const ImVec2& size) {
-    if (computing) {
-        ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
-        ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
-    }
-
     const bool ret = ImGui::Button(label, size);
 
     if (computing) {
-        ImGui::PopItemFlag();
-        ImGui::PopStyleVar();
         ImGui::SameLine();
         ImGui::Text("%c", "|/-\\"[static_cast<int>(ImGui::GetTime() / 0.05f) & 3]);
     }
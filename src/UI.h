@@ -8,6 +8,7 @@ namespace ImGui {
 
     void CurveEditor(const char* label, Curve& curve, ImVec2 size = ImVec2(150, 150));
 
+    // Spins while computing, but stays clickable: a new request pre-empts the running one
     bool ComputeButton(const char* label, bool computing, const ImVec2& size = ImVec2(0, 0));
 
 } // namespace ImGui